@@ -0,0 +1,236 @@
+// Headless benchmark: builds the dashboard once per ingest/store/batcher/renderer mode
+// against the in-process simulated fleet, drives each build in headless Chromium, and
+// records frame times, long tasks, heap growth and ingest latency per fleet size.
+//
+//   npm run bench -- --vehicles 1000,10000 --rate 2000 --duration 20
+//   npm run bench -- --ingest worker --renderer webgl --baseline bench-baseline.json
+//
+// A run fails (exit 1) when any mode records no updates or flushes. With --baseline
+// it also fails when a result regresses past --tolerance;
+// --save-baseline writes this run as the new baseline. A missing --baseline file only
+// skips the comparison, so the first CI run can record one.
+import { access, mkdir, readFile, writeFile } from 'node:fs/promises';
+import { join, resolve } from 'node:path';
+import { parseArgs } from 'node:util';
+import { build, preview } from 'vite';
+import { chromium } from 'playwright';
+
+const MODES = {
+  ingest: ['main', 'worker'],
+  store: ['objects', 'columnar'],
+  schedule: ['timeout', 'frame'],
+  renderer: ['markers', 'webgl']
+};
+
+const { values: args } = parseArgs({
+  options: {
+    vehicles: { type: 'string', default: '1000,10000' },
+    rate: { type: 'string', default: '1000' },
+    messages: { type: 'string', default: '10' },
+    duration: { type: 'string', default: '15' },
+    warmup: { type: 'string', default: '5' },
+    ingest: { type: 'string', default: MODES.ingest.join(',') },
+    store: { type: 'string', default: MODES.store.join(',') },
+    schedule: { type: 'string', default: MODES.schedule.join(',') },
+    renderer: { type: 'string', default: MODES.renderer.join(',') },
+    out: { type: 'string', default: 'bench-results' },
+    baseline: { type: 'string' },
+    'save-baseline': { type: 'string' },
+    tolerance: { type: 'string', default: '0.2' }
+  }
+});
+
+const list = (value) => value.split(',').map(item => item.trim()).filter(Boolean);
+const sizes = list(args.vehicles).map(Number);
+const durationMs = Number(args.duration) * 1000;
+const warmupMs = Number(args.warmup) * 1000;
+const tolerance = Number(args.tolerance);
+
+// Every combination of the selected modes
+const configs = list(args.ingest).flatMap(ingest =>
+  list(args.store).flatMap(store =>
+    list(args.schedule).flatMap(schedule =>
+      list(args.renderer).map(renderer => ({ ingest, store, schedule, renderer })))));
+
+const configName = ({ ingest, store, schedule, renderer }) => `${ingest}-${store}-${schedule}-${renderer}`;
+
+const quantile = (values, p) => {
+  if (values.length === 0) return 0;
+  const sorted = [...values].sort((a, b) => a - b);
+  return sorted[Math.min(sorted.length - 1, Math.floor(p * sorted.length))];
+};
+
+const round = (value, digits = 1) => Math.round(value * 10 ** digits) / 10 ** digits;
+
+// Installed before any page script: records rAF intervals and long tasks while `recording`
+const instrumentPage = () => {
+  const bench = { recording: false, frames: [], longTasks: [], last: 0 };
+  window.__bench = bench;
+  const loop = (time) => {
+    if (bench.recording && bench.last) bench.frames.push(time - bench.last);
+    bench.last = time;
+    requestAnimationFrame(loop);
+  };
+  requestAnimationFrame(loop);
+  new PerformanceObserver((entries) => {
+    if (bench.recording) entries.getEntries().forEach(entry => bench.longTasks.push(entry.duration));
+  }).observe({ type: 'longtask' });
+};
+
+const heapUsedMb = async (cdp) => {
+  await cdp.send('HeapProfiler.collectGarbage');
+  const { usedSize } = await cdp.send('Runtime.getHeapUsage');
+  return usedSize / (1024 * 1024);
+};
+
+const buildConfig = async (config) => {
+  const outDir = resolve('node_modules/.bench', configName(config));
+  Object.assign(process.env, {
+    VITE_WS_URL: `mock://fleet?messages=${args.messages}`,
+    VITE_MOCK_TELEMETRY: 'true',
+    VITE_INGEST_MODE: config.ingest,
+    VITE_VEHICLE_STORE: config.store,
+    VITE_FLUSH_SCHEDULE: config.schedule,
+    VITE_MAP_RENDERER: config.renderer,
+    VITE_PERF_METRICS: 'true',
+    VITE_BENCHMARK: 'true',
+    VITE_WARM_START: 'false'
+  });
+  await build({ logLevel: 'warn', build: { outDir, emptyOutDir: true } });
+  return outDir;
+};
+
+const runPage = async (browser, url, vehicles) => {
+  const page = await browser.newPage({ viewport: { width: 1600, height: 1000 } });
+  // Map tiles are network noise, not dashboard work
+  await page.route(/tile\.openstreetmap\.org/, route => route.abort());
+  await page.addInitScript(instrumentPage);
+  const cdp = await page.context().newCDPSession(page);
+
+  await page.goto(`${url}?vehicles=${vehicles}&rate=${args.rate}`);
+  await page.waitForTimeout(warmupMs);
+
+  const heapStart = await heapUsedMb(cdp);
+  await page.evaluate(() => {
+    window.__bench.recording = true;
+    window.__bench.stop = window.fleetMetrics.collect();
+  });
+  await page.waitForTimeout(durationMs);
+  const { frames, longTasks, metrics } = await page.evaluate(() => {
+    window.__bench.recording = false;
+    return { frames: window.__bench.frames, longTasks: window.__bench.longTasks, metrics: window.__bench.stop() };
+  });
+  const heapEnd = await heapUsedMb(cdp);
+  await page.close();
+
+  const histogram = (name, field) => metrics.histograms[name]?.[field] ?? 0;
+  return {
+    fps: round(frames.length / (durationMs / 1000)),
+    frameP50: round(quantile(frames, 0.5)),
+    frameP95: round(quantile(frames, 0.95)),
+    frameP99: round(quantile(frames, 0.99)),
+    jankyFrames: frames.filter(frame => frame > 1000 / 30).length,
+    longTasks: longTasks.length,
+    longTaskMs: round(longTasks.reduce((sum, duration) => sum + duration, 0)),
+    heapStartMb: round(heapStart),
+    heapGrowthMb: round(heapEnd - heapStart),
+    updatesPerSecond: round(metrics.counters['batch.updates']?.perSecond ?? 0, 0),
+    // Flushes recorded; 0 means the batcher's metrics never reached the page
+    flushes: metrics.histograms['batch.flush_ms']?.count ?? 0,
+    latencyP50: round(histogram('latency.e2e_ms', 'p50')),
+    latencyP99: round(histogram('latency.e2e_ms', 'p99')),
+    flushP99: round(histogram('batch.flush_ms', 'p99'), 2),
+    storeP99: round(histogram('store.update_ms', 'p99'), 2),
+    mapP99: round(histogram('map.update_ms', 'p99'), 2)
+  };
+};
+
+// Metrics where larger is worse, with the absolute slack that absorbs run-to-run noise
+const REGRESSION_CHECKS = [
+  ['frameP95', 2],
+  ['latencyP99', 20],
+  ['longTaskMs', 100],
+  ['heapGrowthMb', 5],
+  ['flushP99', 2]
+];
+// Metrics where smaller is worse
+const THROUGHPUT_CHECKS = [
+  ['updatesPerSecond', 50]
+];
+
+const findRegressions = (results, baseline) => results.flatMap((result) => {
+  const previous = baseline.find(entry => entry.config === result.config && entry.vehicles === result.vehicles);
+  if (!previous) return [];
+  const describe = ([key]) => `${result.config} @ ${result.vehicles}: ${key} ${previous[key]} -> ${result[key]}`;
+  return [
+    ...REGRESSION_CHECKS.filter(([key, slack]) => result[key] > previous[key] * (1 + tolerance) + slack),
+    ...THROUGHPUT_CHECKS.filter(([key, slack]) => result[key] < previous[key] * (1 - tolerance) - slack)
+  ].map(describe);
+});
+
+const main = async () => {
+  const browser = await chromium.launch({ args: ['--enable-precise-memory-info'] });
+  const results = [];
+
+  try {
+    for (const config of configs) {
+      const name = configName(config);
+      console.log(`Building ${name}...`);
+      const outDir = await buildConfig(config);
+      const server = await preview({ logLevel: 'warn', build: { outDir }, preview: { port: 4173, strictPort: false } });
+      const url = server.resolvedUrls.local[0];
+      try {
+        for (const vehicles of sizes) {
+          console.log(`  ${vehicles.toLocaleString()} vehicles at ${args.rate} updates/s`);
+          results.push({ config: name, ...config, vehicles, ...(await runPage(browser, url, vehicles)) });
+        }
+      } finally {
+        await new Promise(done => server.httpServer.close(done));
+      }
+    }
+  } finally {
+    await browser.close();
+  }
+
+  console.table(results.map(({ ingest, store, schedule, renderer, ...row }) => row));
+
+  await mkdir(args.out, { recursive: true });
+  const file = join(args.out, `bench-${new Date().toISOString().replace(/[:.]/g, '-')}.json`);
+  await writeFile(file, JSON.stringify({ rate: Number(args.rate), durationMs, results }, null, 2));
+  console.log(`Results written to ${file}`);
+
+  // A run whose ingest metrics read zero measures nothing and must not become a baseline
+  const unmeasured = results.filter(result => result.updatesPerSecond === 0 || result.flushes === 0);
+  if (unmeasured.length > 0) {
+    console.error('No ingest metrics recorded for:');
+    unmeasured.forEach(result => console.error(`  ${result.config} @ ${result.vehicles}`));
+    process.exitCode = 1;
+    return;
+  }
+
+  if (args['save-baseline']) {
+    await writeFile(args['save-baseline'], JSON.stringify(results, null, 2));
+    console.log(`Baseline saved to ${args['save-baseline']}`);
+  }
+
+  const hasBaseline = args.baseline && await access(args.baseline).then(() => true, () => false);
+  if (args.baseline && !hasBaseline) {
+    console.warn(`Baseline ${args.baseline} not found; skipping the regression check`);
+  }
+
+  if (hasBaseline) {
+    const regressions = findRegressions(results, JSON.parse(await readFile(args.baseline, 'utf8')));
+    if (regressions.length > 0) {
+      console.error(`Regressions beyond ${tolerance * 100}% of ${args.baseline}:`);
+      regressions.forEach(line => console.error(`  ${line}`));
+      process.exitCode = 1;
+    } else {
+      console.log(`No regressions against ${args.baseline}`);
+    }
+  }
+};
+
+main().catch((error) => {
+  console.error(error);
+  process.exitCode = 1;
+});
@@ -1,38 +1,131 @@
 /// <reference types="vite/client" />
-import { useEffect, useRef } from 'react';
-import { useFleetStore } from './stores/fleetStore';
-import { TelemetryWebSocketClient } from './api/websocketClient';
-import { VehicleUpdateBatcher } from './utils/batcher';
+import { Profiler, ProfilerOnRenderCallback, useEffect, useRef } from 'react';
+import { useFleetStore, subscribeVehicleDeltas } from './stores/fleetStore';
+import { TelemetryClient, TelemetryWebSocketClient } from './api/websocketClient';
+import { WorkerTelemetryClient } from './api/workerTelemetryClient';
+import { SharedTelemetryClient } from './api/sharedTelemetryClient';
+import { RestApiClient } from './api/restClient';
+import { MetricsExporter } from './api/metricsExporter';
+import { AlertMonitor } from './stores/alertMonitor';
+import { withPageMockParams } from './api/mockUrl';
+import { VehicleUpdateBatcher, FlushSchedule } from './utils/batcher';
 import MapView from './components/MapView';
 import VehicleList from './components/VehicleList';
 import FilterControls from './components/FilterControls';
+import FleetKpis from './components/FleetKpis';
 import ConnectionStatus from './components/ConnectionStatus';
+import VehicleHistoryChart from './components/VehicleHistoryChart';
+import ReplayControls from './components/ReplayControls';
 import ErrorBoundary from './components/ErrorBoundary';
+import PerfHud from './components/PerfHud';
+import AlertFeed from './components/AlertFeed';
+import { IngestFocus, VehicleUpdate } from './types';
+import { sameFilterCriteria } from './utils/filterIndex';
+import { PERF_METRICS, PerfHistogram, perfRecord } from './utils/perfMetrics';
 
-const WS_URL = import.meta.env.VITE_WS_URL || 'ws://localhost:8080/v1/telemetry/stream';
+// A `mock://fleet?vehicles=…&rate=…` URL streams a simulated fleet instead (see mockUrl and mockTelemetrySocket)
+const WS_URL = withPageMockParams(import.meta.env.VITE_WS_URL || 'ws://localhost:8080/v1/telemetry/stream');
 const BATCH_INTERVAL = parseInt(import.meta.env.VITE_UPDATE_BATCH_INTERVAL || '100', 10);
+// 'worker' moves socket handling, parsing and coalescing off the main thread;
+// 'shared' does so in a SharedWorker whose single socket serves every open tab
+const INGEST_MODE = import.meta.env.VITE_INGEST_MODE || 'main';
+const BINARY_TELEMETRY = import.meta.env.VITE_WS_BINARY === 'true';
+// 'frame' aligns flushes to requestAnimationFrame, with BATCH_INTERVAL as the back-off ceiling
+const FLUSH_SCHEDULE: FlushSchedule = import.meta.env.VITE_FLUSH_SCHEDULE === 'frame' ? 'frame' : 'timeout';
+// Subscribe to the visible map area only; the map culls markers to the same bounds
+const VIEWPORT_CULLING = import.meta.env.VITE_VIEWPORT_CULLING === 'true';
+// Seconds between client metrics reports to the API; 0 disables export
+const METRICS_EXPORT_INTERVAL = parseInt(import.meta.env.VITE_METRICS_EXPORT_INTERVAL || '0', 10);
+// Below this zoom the marker renderer draws a dense fleet almost entirely as clusters,
+// so load shedding may delay on-screen vehicles too; the WebGL layer never clusters
+const SHED_CLUSTER_ZOOM = import.meta.env.VITE_MAP_RENDERER === 'webgl' ? 0 : 13;
+// Evaluate geofence and staleness rules against the live stream
+const ALERTS = import.meta.env.VITE_ALERTS === 'true';
 
 // Mock token - replace with actual auth
 const AUTH_TOKEN = 'mock-jwt-token';
 
+const restClient = new RestApiClient(import.meta.env.VITE_API_URL || '', AUTH_TOKEN);
+
+type FocusState = Pick<ReturnType<typeof useFleetStore.getState>, 'viewport' | 'selectedVehicleId' | 'pinnedVehicleIds'>;
+
+const focusOf = ({ viewport, selectedVehicleId, pinnedVehicleIds }: FocusState): IngestFocus => {
+  const vehicleIds = Array.from(pinnedVehicleIds);
+  if (selectedVehicleId && !pinnedVehicleIds.has(selectedVehicleId)) vehicleIds.push(selectedVehicleId);
+  return {
+    bounds: viewport,
+    clustered: viewport !== null && viewport.zoom < SHED_CLUSTER_ZOOM,
+    vehicleIds
+  };
+};
+
+// React only calls Profiler callbacks in development and profiling builds
+const recordCommit: ProfilerOnRenderCallback = (_id, _phase, actualDuration) => {
+  perfRecord(PerfHistogram.REACT_COMMIT, actualDuration);
+};
+
 function App() {
-  const wsClientRef = useRef<TelemetryWebSocketClient | null>(null);
+  const wsClientRef = useRef<TelemetryClient | null>(null);
   const batcherRef = useRef<VehicleUpdateBatcher | null>(null);
   const updateVehicles = useFleetStore(state => state.updateVehicles);
   const setConnectionStatus = useFleetStore(state => state.setConnectionStatus);
+  const setClusterSummaries = useFleetStore(state => state.setClusterSummaries);
 
   useEffect(() => {
-    // Initialize batcher
-    batcherRef.current = new VehicleUpdateBatcher(BATCH_INTERVAL, (updates) => {
-      updateVehicles(updates);
-    });
+    // A running replay owns the vehicle table; the socket stays connected but its updates are dropped
+    const applyLive = (updates: Map<string, VehicleUpdate>) => {
+      if (!useFleetStore.getState().replayActive) updateVehicles(updates);
+    };
 
     // Initialize WebSocket client
-    wsClientRef.current = new TelemetryWebSocketClient(WS_URL, AUTH_TOKEN);
+    const shared = INGEST_MODE === 'shared' && typeof SharedWorker !== 'undefined';
+    // Without SharedWorker support, shared mode falls back to a per-tab worker
+    const offMainThread = shared || ((INGEST_MODE === 'worker' || INGEST_MODE === 'shared') && typeof Worker !== 'undefined');
+    let unsubscribeFilters: (() => void) | null = null;
+    let unsubscribeDeltas: (() => void) | null = null;
+    if (shared) {
+      const sharedClient = new SharedTelemetryClient(WS_URL, AUTH_TOKEN, { binary: BINARY_TELEMETRY });
+      // Only vehicles this tab's filters select are forwarded by the worker
+      let filters = useFleetStore.getState().filters;
+      sharedClient.subscribeFilter(filters);
+      unsubscribeFilters = useFleetStore.subscribe((state) => {
+        if (state.filters !== filters && !sameFilterCriteria(state.filters, filters)) {
+          sharedClient.subscribeFilter(state.filters);
+        }
+        filters = state.filters;
+      });
+      // The tab holds a subset, so fleet-wide counters come from the worker's table
+      sharedClient.onRemove((vehicleIds) => {
+        if (!useFleetStore.getState().replayActive) useFleetStore.getState().removeVehicles(vehicleIds);
+      });
+      sharedClient.onFleetCounts((counts) => {
+        if (!useFleetStore.getState().replayActive) useFleetStore.getState().setFleetCounts(counts);
+      });
+      wsClientRef.current = sharedClient;
+    } else if (offMainThread) {
+      wsClientRef.current = new WorkerTelemetryClient(WS_URL, AUTH_TOKEN, { binary: BINARY_TELEMETRY });
+    } else {
+      const socketClient = new TelemetryWebSocketClient(WS_URL, AUTH_TOKEN, { binary: BINARY_TELEMETRY });
+      batcherRef.current = new VehicleUpdateBatcher(BATCH_INTERVAL, applyLive, {
+        onResync: (vehicleIds) => socketClient.requestResync(vehicleIds),
+        schedule: FLUSH_SCHEDULE
+      });
+      socketClient.onPatch((patches) => batcherRef.current?.addPatches(patches));
+      socketClient.onStreamReset(() => batcherRef.current?.forget());
+      // Vehicles that left the table need a fresh snapshot before their patches apply again
+      unsubscribeDeltas = subscribeVehicleDeltas((delta) => {
+        if (delta.cleared) batcherRef.current?.forget();
+        if (delta.removed.length > 0) batcherRef.current?.forget(delta.removed.map(vehicle => vehicle.id));
+      });
+      wsClientRef.current = socketClient;
+    }
 
     // Handle incoming messages
     wsClientRef.current.onMessage((data) => {
-      if (Array.isArray(data)) {
+      if (offMainThread) {
+        // The worker already delivers coalesced batches
+        applyLive(new Map((data as VehicleUpdate[]).map(v => [v.id, v])));
+      } else if (Array.isArray(data)) {
         batcherRef.current?.addBatch(data);
       } else {
         batcherRef.current?.addUpdate(data.id, data);
@@ -49,47 +142,110 @@ function App() {
       console.error('WebSocket error:', error);
     });
 
+    wsClientRef.current.onClusterSummary((summaries) => {
+      setClusterSummaries(summaries);
+    });
+
+    // Forward map viewport changes as socket subscriptions
+    let unsubscribeViewport: (() => void) | null = null;
+    if (VIEWPORT_CULLING) {
+      let viewport = useFleetStore.getState().viewport;
+      if (viewport) wsClientRef.current.subscribeViewport(viewport);
+      unsubscribeViewport = useFleetStore.subscribe((state) => {
+        if (state.viewport && state.viewport !== viewport) {
+          viewport = state.viewport;
+          wsClientRef.current?.subscribeViewport(viewport);
+        }
+      });
+    }
+
+    // Tell load shedding what is on screen and which vehicles are being followed
+    let focus: FocusState = useFleetStore.getState();
+    wsClientRef.current.setFocus(focusOf(focus));
+    const unsubscribeFocus = useFleetStore.subscribe((state) => {
+      if (
+        state.viewport !== focus.viewport ||
+        state.selectedVehicleId !== focus.selectedVehicleId ||
+        state.pinnedVehicleIds !== focus.pinnedVehicleIds
+      ) {
+        focus = state;
+        wsClientRef.current?.setFocus(focusOf(state));
+      }
+    });
+
     // Connect
     wsClientRef.current.connect();
 
     // Cleanup
     return () => {
+      unsubscribeFocus();
+      unsubscribeViewport?.();
+      unsubscribeFilters?.();
+      unsubscribeDeltas?.();
       batcherRef.current?.destroy();
       wsClientRef.current?.disconnect();
     };
-  }, [updateVehicles, setConnectionStatus]);
+  }, [updateVehicles, setConnectionStatus, setClusterSummaries]);
+
+  useEffect(() => {
+    if (!PERF_METRICS || METRICS_EXPORT_INTERVAL <= 0) return;
+    const exporter = new MetricsExporter(restClient, METRICS_EXPORT_INTERVAL * 1000);
+    exporter.start();
+    return () => exporter.stop();
+  }, []);
+
+  useEffect(() => {
+    if (!ALERTS) return;
+    const monitor = new AlertMonitor(restClient);
+    monitor.start();
+    return () => monitor.stop();
+  }, []);
 
   return (
     <ErrorBoundary>
-      <div className="h-screen flex flex-col bg-gray-50">
-        {/* Header */}
-        <header className="bg-white shadow-sm border-b border-gray-200 px-6 py-4">
-          <div className="flex items-center justify-between">
-            <h1 className="text-2xl font-bold text-gray-900">
-              Fleet Dashboard
-            </h1>
-            <ConnectionStatus />
-          </div>
-        </header>
-
-        {/* Main Content */}
-        <div className="flex-1 flex overflow-hidden">
-          {/* Left Sidebar - Filters and Vehicle List */}
-          <aside className="w-96 bg-white border-r border-gray-200 flex flex-col">
-            <div className="p-4 border-b border-gray-200">
-              <FilterControls />
-            </div>
-            <div className="flex-1 overflow-hidden">
-              <VehicleList />
+      <Profiler id="dashboard" onRender={recordCommit}>
+        <div className="h-screen flex flex-col bg-gray-50">
+          {/* Header */}
+          <header className="bg-white shadow-sm border-b border-gray-200 px-6 py-4">
+            <div className="flex items-center justify-between">
+              <h1 className="text-2xl font-bold text-gray-900">
+                Fleet Dashboard
+              </h1>
+              <div className="flex items-center gap-6">
+                <ReplayControls client={restClient} />
+                {ALERTS && <AlertFeed />}
+                <ConnectionStatus />
+                {PERF_METRICS && <PerfHud />}
+              </div>
             </div>
-          </aside>
+          </header>
 
-          {/* Main Map Area */}
-          <main className="flex-1 relative">
-            <MapView />
-          </main>
+          {/* Main Content */}
+          <div className="flex-1 flex overflow-hidden">
+            {/* Left Sidebar - Filters and Vehicle List */}
+            <aside className="w-96 bg-white border-r border-gray-200 flex flex-col">
+              <div className="p-4 border-b border-gray-200">
+                <FleetKpis />
+              </div>
+              <div className="p-4 border-b border-gray-200">
+                <FilterControls />
+              </div>
+              <div className="flex-1 overflow-hidden">
+                <VehicleList />
+              </div>
+            </aside>
+
+            {/* Main Map Area */}
+            <main className="flex-1 flex flex-col min-w-0">
+              <div className="flex-1 relative min-h-0">
+                <MapView />
+              </div>
+              {/* Selected vehicle history; renders nothing until a vehicle is selected */}
+              <VehicleHistoryChart client={restClient} />
+            </main>
+          </div>
         </div>
-      </div>
+      </Profiler>
     </ErrorBoundary>
   );
 }
@@ -0,0 +1,67 @@
+import { MetricsAccumulator, onMetricsWindow } from '../utils/perfMetrics';
+import { RestApiClient, ClientMetricsReport } from './restClient';
+
+const createClientId = (): string =>
+  typeof crypto !== 'undefined' && 'randomUUID' in crypto
+    ? crypto.randomUUID()
+    : Math.random().toString(36).slice(2);
+
+/**
+ * Rolls the one-second metrics windows up into a report per export period and
+ * posts it to the API, so end-to-end latency can be compared across browsers.
+ * The partial period is sent when the page is hidden or unloaded.
+ */
+export class MetricsExporter {
+  private client: RestApiClient;
+  private intervalMs: number;
+  private clientId: string = createClientId();
+  private period = new MetricsAccumulator();
+  private timer: ReturnType<typeof setInterval> | null = null;
+  private unsubscribe: (() => void) | null = null;
+
+  constructor(client: RestApiClient, intervalMs: number) {
+    this.client = client;
+    this.intervalMs = intervalMs;
+  }
+
+  public start(): void {
+    if (this.timer) return;
+    const unsubscribeWindows = onMetricsWindow(metrics => this.period.add(metrics));
+    const onHide = () => {
+      if (document.visibilityState === 'hidden') this.flush();
+    };
+    document.addEventListener('visibilitychange', onHide);
+    window.addEventListener('pagehide', onHide);
+    this.timer = setInterval(() => this.flush(), this.intervalMs);
+    this.unsubscribe = () => {
+      unsubscribeWindows();
+      document.removeEventListener('visibilitychange', onHide);
+      window.removeEventListener('pagehide', onHide);
+    };
+  }
+
+  public stop(): void {
+    this.flush();
+    this.unsubscribe?.();
+    this.unsubscribe = null;
+    if (this.timer) clearInterval(this.timer);
+    this.timer = null;
+  }
+
+  // Posts what was collected since the last report, if anything
+  public flush(): void {
+    if (this.period.empty) return;
+    const { start, end, counters, histograms } = this.period.take();
+    const report: ClientMetricsReport = {
+      clientId: this.clientId,
+      start: new Date(start).toISOString(),
+      end: new Date(end).toISOString(),
+      counters,
+      histograms
+    };
+
+    this.client.postClientMetrics(report).catch((error) => {
+      console.warn('Failed to export client metrics:', error);
+    });
+  }
+}
@@ -0,0 +1,76 @@
+import { VehicleData, WebSocketMessage } from '../types';
+import { FleetSimulator } from '../utils/fleetSimulator';
+import { MockTelemetryConfig, parseMockUrl } from './mockUrl';
+
+const CONNECTING = 0;
+const OPEN = 1;
+const CLOSED = 3;
+
+/**
+ * Stand-in for a WebSocket that emits simulated `batch_update` messages at a
+ * fixed rate. The first message is a full snapshot of the fleet, as a server
+ * would send on connect. It implements only what TelemetryWebSocketClient
+ * uses and speaks JSON only. Of what the client sends only `throttle` is
+ * honoured, capping the rate; viewport subscriptions have no effect.
+ */
+export class MockTelemetrySocket {
+  public readyState: number = CONNECTING;
+  public protocol: string = '';
+  public binaryType: BinaryType = 'arraybuffer';
+  public onopen: ((event: Event) => void) | null = null;
+  public onmessage: ((event: MessageEvent) => void) | null = null;
+  public onerror: ((event: Event) => void) | null = null;
+  public onclose: ((event: CloseEvent) => void) | null = null;
+  private simulator: FleetSimulator;
+  private config: MockTelemetryConfig;
+  private timer: ReturnType<typeof setInterval> | null = null;
+  // Fractional updates carried between messages so low rates are still honoured
+  private carry: number = 0;
+  // Updates per second the client asked for with `throttle`; null for the configured rate
+  private maxRate: number | null = null;
+
+  constructor(url: string) {
+    this.config = parseMockUrl(url);
+    this.simulator = new FleetSimulator({ vehicles: this.config.vehicles, seed: this.config.seed });
+    setTimeout(() => this.open(), 0);
+  }
+
+  public send(data: string): void {
+    const message = JSON.parse(data);
+    if (message.type === 'throttle') this.maxRate = message.maxUpdatesPerSecond ?? null;
+  }
+
+  public close(code: number = 1000): void {
+    if (this.readyState === CLOSED) return;
+    this.readyState = CLOSED;
+    if (this.timer) clearInterval(this.timer);
+    this.timer = null;
+    // Delivered asynchronously, as a real socket does
+    setTimeout(() => this.onclose?.({ code } as CloseEvent), 0);
+  }
+
+  private open(): void {
+    if (this.readyState !== CONNECTING) return;
+    this.readyState = OPEN;
+    this.onopen?.(new Event('open'));
+    this.emit(this.simulator.snapshot());
+
+    const periodMs = 1000 / this.config.messages;
+    this.timer = setInterval(() => {
+      this.carry += Math.min(this.config.rate, this.maxRate ?? Infinity) / this.config.messages;
+      const count = Math.floor(this.carry);
+      this.carry -= count;
+      if (count > 0) this.emit(this.simulator.next(count));
+    }, periodMs);
+  }
+
+  private emit(vehicles: VehicleData[]): void {
+    const message: WebSocketMessage = {
+      type: 'batch_update',
+      data: vehicles,
+      timestamp: new Date().toISOString()
+    };
+    // Serialized like a real frame, so parse cost is part of what gets measured
+    this.onmessage?.({ data: JSON.stringify(message) } as MessageEvent);
+  }
+}
@@ -0,0 +1,43 @@
+// Stream URLs with this scheme are served in-process by the simulator
+export const MOCK_SCHEME = 'mock:';
+
+// Simulator parameters that may be given in the stream URL or the page query string
+const MOCK_PARAMS = ['vehicles', 'rate', 'messages', 'seed'];
+
+export interface MockTelemetryConfig {
+  vehicles: number;
+  // Vehicle updates per second across the fleet
+  rate: number;
+  // Socket messages per second; each carries rate / messages updates
+  messages: number;
+  seed: number;
+}
+
+// `url` is `mock://fleet?vehicles=10000&rate=5000&messages=20`; anything after a second `?` is ignored
+export const parseMockUrl = (url: string): MockTelemetryConfig => {
+  const params = new URLSearchParams(url.split('?')[1] ?? '');
+  const read = (name: string, fallback: number) => {
+    const value = parseInt(params.get(name) ?? '', 10);
+    return Number.isFinite(value) && value > 0 ? value : fallback;
+  };
+  return {
+    vehicles: read('vehicles', 1000),
+    rate: read('rate', 1000),
+    messages: read('messages', 10),
+    seed: read('seed', 1)
+  };
+};
+
+// Lets the page query override a mock stream's parameters (`/?vehicles=50000`), so one
+// build serves every benchmark size; real stream URLs are returned unchanged
+export const withPageMockParams = (url: string): string => {
+  if (!url.startsWith(MOCK_SCHEME) || typeof location === 'undefined') return url;
+  const page = new URLSearchParams(location.search);
+  const [base, query = ''] = url.split('?');
+  const params = new URLSearchParams(query);
+  MOCK_PARAMS.forEach((name) => {
+    const value = page.get(name);
+    if (value) params.set(name, value);
+  });
+  return `${base}?${params}`;
+};
@@ -0,0 +1,59 @@
+import { RestApiClient } from './restClient';
+import { ReplayTimeline, DEFAULT_TRACK_CAPACITY } from '../utils/replayTimeline';
+import { TimeWindow } from '../utils/timeRange';
+
+// Browsers allow about six concurrent requests per host
+const DEFAULT_CONCURRENCY = 6;
+
+export interface LoadFleetHistoryOptions {
+  capacity?: number;
+  concurrency?: number;
+  signal?: AbortSignal;
+  onProgress?: (loaded: number, total: number) => void;
+}
+
+// Streams every vehicle's history into one sealed timeline. The interval hint asks
+// the server for no more rows than a track keeps, and the timeline decimates
+// whatever exceeds it; vehicles that fail are skipped.
+export const loadFleetHistory = async (
+  client: RestApiClient,
+  vehicleIds: string[],
+  window: TimeWindow,
+  options: LoadFleetHistoryOptions = {}
+): Promise<ReplayTimeline> => {
+  const capacity = options.capacity ?? DEFAULT_TRACK_CAPACITY;
+  const timeline = new ReplayTimeline(window.start, window.end, capacity);
+  const interval = Math.max(1, Math.ceil((window.end - window.start) / 1000 / capacity));
+  const start = new Date(window.start).toISOString();
+  const end = new Date(window.end).toISOString();
+  let next = 0;
+  let loaded = 0;
+
+  const worker = async () => {
+    while (next < vehicleIds.length && !options.signal?.aborted) {
+      const vehicleId = vehicleIds[next++];
+      try {
+        const series = await client.streamHistoricalData(
+          { vehicleId, start, end, interval },
+          { signal: options.signal }
+        );
+        timeline.addSeries(series);
+      } catch (error) {
+        if (options.signal?.aborted) break;
+        console.error(`Failed to load history for ${vehicleId}:`, error);
+      }
+      options.onProgress?.(++loaded, vehicleIds.length);
+    }
+  };
+
+  await Promise.all(
+    Array.from({ length: Math.min(options.concurrency ?? DEFAULT_CONCURRENCY, vehicleIds.length) }, worker)
+  );
+  if (options.signal?.aborted) throw new DOMException('Replay load aborted', 'AbortError');
+
+  if (timeline.droppedSamples > 0) {
+    console.warn(`Replay kept one sample per ${interval} s per vehicle; ${timeline.droppedSamples} denser samples were dropped`);
+  }
+  timeline.seal();
+  return timeline;
+};
@@ -0,0 +1,101 @@
+export interface CacheEntry {
+  body: unknown;
+  etag: string | null;
+  expires: number; // epoch ms
+}
+
+// Fetches a fresh entry, or returns `cached` with a new expiry when the server answers 304
+export type CacheLoader = (signal: AbortSignal, cached: CacheEntry | undefined) => Promise<CacheEntry>;
+
+interface InFlight {
+  promise: Promise<unknown>;
+  controller: AbortController;
+  consumers: number;
+}
+
+const abortError = () => new DOMException('Request aborted', 'AbortError');
+
+/**
+ * LRU response cache with in-flight dedup. Concurrent requests for one key
+ * share a single fetch; each caller can abort its own wait, and the shared
+ * fetch is aborted once every caller has. Expired entries are kept for their
+ * ETag so the refetch can be a conditional request. Cached bodies are shared
+ * between callers and must be treated as read-only.
+ */
+export class RequestCache {
+  private entries: Map<string, CacheEntry> = new Map();
+  private inflight: Map<string, InFlight> = new Map();
+  private maxEntries: number;
+
+  constructor(maxEntries: number = 200) {
+    this.maxEntries = maxEntries;
+  }
+
+  public fetch<T>(key: string, load: CacheLoader, options: { signal?: AbortSignal; force?: boolean } = {}): Promise<T> {
+    const cached = this.entries.get(key);
+    if (cached) {
+      // Refresh the LRU position
+      this.entries.delete(key);
+      this.entries.set(key, cached);
+      if (!options.force && cached.expires > Date.now()) return Promise.resolve(cached.body as T);
+    }
+
+    let flight = this.inflight.get(key);
+    if (!flight) {
+      const controller = new AbortController();
+      const promise = load(controller.signal, cached).then(entry => {
+        this.store(key, entry);
+        return entry.body;
+      });
+      const started: InFlight = { promise, controller, consumers: 0 };
+      promise.then(
+        () => this.settle(key, started),
+        () => this.settle(key, started)
+      );
+      this.inflight.set(key, started);
+      flight = started;
+    }
+    return this.join(flight, key, options.signal) as Promise<T>;
+  }
+
+  // Drops cached entries whose key starts with `prefix` (all entries when omitted)
+  public invalidate(prefix: string = ''): void {
+    for (const key of Array.from(this.entries.keys())) {
+      if (key.startsWith(prefix)) this.entries.delete(key);
+    }
+  }
+
+  private join(flight: InFlight, key: string, signal: AbortSignal | undefined): Promise<unknown> {
+    flight.consumers++;
+    if (!signal) return flight.promise;
+
+    return new Promise((resolve, reject) => {
+      const onAbort = () => {
+        reject(abortError());
+        if (--flight.consumers === 0) {
+          // Later callers must not join a fetch that is being torn down
+          this.settle(key, flight);
+          flight.controller.abort();
+        }
+      };
+      if (signal.aborted) {
+        onAbort();
+        return;
+      }
+      signal.addEventListener('abort', onAbort, { once: true });
+      flight.promise.then(resolve, reject).finally(() => signal.removeEventListener('abort', onAbort));
+    });
+  }
+
+  private settle(key: string, flight: InFlight): void {
+    if (this.inflight.get(key) === flight) this.inflight.delete(key);
+  }
+
+  private store(key: string, entry: CacheEntry): void {
+    this.entries.delete(key);
+    this.entries.set(key, entry);
+    if (this.entries.size > this.maxEntries) {
+      this.entries.delete(this.entries.keys().next().value as string);
+    }
+  }
+}
@@ -1,8 +1,32 @@
-import { HistoricalDataRequest, HistoricalDataResponse, VehicleData } from '../types';
+import { AlertRule, Geofence, HistoricalDataRequest, HistoricalDataResponse, VehicleData } from '../types';
+import { readNdjson } from '../utils/ndjsonStream';
+import { TelemetrySeries } from '../utils/telemetrySeries';
+import { HistogramSummary } from '../utils/perfMetrics';
+import { RequestCache, CacheEntry } from './requestCache';
+
+// How long a cached response is served without asking the server again
+const VEHICLE_TTL_MS = 5_000;
+const HISTORY_TTL_MS = 60_000;
+const ANALYTICS_TTL_MS = 30_000;
+const GEOFENCE_TTL_MS = 5 * 60_000;
+
+export interface RequestOptions {
+  // Aborts this caller's wait; a shared request is cancelled only when all its callers abort
+  signal?: AbortSignal;
+  // Skip the fresh-cache shortcut; the request is still conditional on the cached ETag
+  force?: boolean;
+}
+
+export interface StreamHistoryOptions {
+  signal?: AbortSignal;
+  // Called after each network chunk is decoded, with the partially filled series
+  onProgress?: (series: TelemetrySeries) => void;
+}
 
 export class RestApiClient {
   private baseUrl: string;
   private token: string;
+  private cache = new RequestCache();
 
   constructor(baseUrl: string, token: string) {
     this.baseUrl = baseUrl;
@@ -18,7 +42,8 @@ export class RestApiClient {
 
     const response = await fetch(url, { ...options, headers });
 
-    if (!response.ok) {
+    // 304 answers a conditional request; the caller reuses its cached body
+    if (!response.ok && response.status !== 304) {
       const error = await response.json().catch(() => ({ message: 'Unknown error' }));
       throw new Error(error.message || `HTTP ${response.status}: ${response.statusText}`);
     }
@@ -26,18 +51,56 @@ export class RestApiClient {
     return response;
   }
 
-  public async getVehicles(): Promise<VehicleData[]> {
-    const response = await this.fetchWithAuth(`${this.baseUrl}/api/fleet/vehicles`);
-    const data = await response.json();
+  // Cached, deduplicated GET revalidated with If-None-Match once the TTL expires
+  private getJson<T>(url: string, ttlMs: number, options: RequestOptions = {}): Promise<T> {
+    return this.cache.fetch<T>(url, async (signal, cached): Promise<CacheEntry> => {
+      const response = await this.fetchWithAuth(url, {
+        signal,
+        headers: cached?.etag ? { 'If-None-Match': cached.etag } : {}
+      });
+      const expires = Date.now() + ttlMs;
+      if (response.status === 304 && cached) return { ...cached, expires };
+      return { body: await response.json(), etag: response.headers.get('ETag'), expires };
+    }, options);
+  }
+
+  // Drops cached responses, e.g. after a write the server will reflect
+  public invalidateCache(): void {
+    this.cache.invalidate();
+  }
+
+  public async getVehicles(options?: RequestOptions): Promise<VehicleData[]> {
+    const data = await this.getJson<{ vehicles?: VehicleData[] }>(
+      `${this.baseUrl}/api/fleet/vehicles`, VEHICLE_TTL_MS, options
+    );
     return data.vehicles || [];
   }
 
-  public async getVehicle(vehicleId: string): Promise<VehicleData> {
-    const response = await this.fetchWithAuth(`${this.baseUrl}/api/vehicles/${vehicleId}`);
-    return response.json();
+  public getVehicle(vehicleId: string, options?: RequestOptions): Promise<VehicleData> {
+    return this.getJson(`${this.baseUrl}/api/vehicles/${vehicleId}`, VEHICLE_TTL_MS, options);
   }
 
-  public async getHistoricalData(request: HistoricalDataRequest): Promise<HistoricalDataResponse> {
+  public getHistoricalData(request: HistoricalDataRequest, options?: RequestOptions): Promise<HistoricalDataResponse> {
+    const params = new URLSearchParams({
+      start: request.start,
+      end: request.end,
+      ...(request.interval && { interval: request.interval.toString() })
+    });
+
+    return this.getJson(
+      `${this.baseUrl}/api/vehicles/${request.vehicleId}/telemetry?${params}`,
+      HISTORY_TTL_MS,
+      options
+    );
+  }
+
+  // Streams the same endpoint as NDJSON straight into typed columns. Servers that
+  // ignore the Accept header and answer with a JSON document are still handled.
+  // Not cached: each call owns its series and may be large.
+  public async streamHistoricalData(
+    request: HistoricalDataRequest,
+    options: StreamHistoryOptions = {}
+  ): Promise<TelemetrySeries> {
     const params = new URLSearchParams({
       start: request.start,
       end: request.end,
@@ -45,17 +108,47 @@ export class RestApiClient {
     });
 
     const response = await this.fetchWithAuth(
-      `${this.baseUrl}/api/vehicles/${request.vehicleId}/telemetry?${params}`
+      `${this.baseUrl}/api/vehicles/${request.vehicleId}/telemetry?${params}`,
+      { headers: { 'Accept': 'application/x-ndjson' }, signal: options.signal }
+    );
+    const series = new TelemetrySeries(request.vehicleId);
+    const contentType = response.headers.get('Content-Type') || '';
+
+    if (!response.body || !contentType.includes('ndjson')) {
+      const data: HistoricalDataResponse = await response.json();
+      data.data.forEach(row => series.push(row));
+      options.onProgress?.(series);
+      return series;
+    }
+
+    await readNdjson<VehicleData>(
+      response.body,
+      row => series.push(row),
+      () => options.onProgress?.(series)
     );
-    return response.json();
+    return series;
   }
 
-  public async getFleetAnalytics(start: string, end: string): Promise<FleetAnalytics> {
+  public getFleetAnalytics(start: string, end: string, options?: RequestOptions): Promise<FleetAnalytics> {
     const params = new URLSearchParams({ start, end });
-    const response = await this.fetchWithAuth(
-      `${this.baseUrl}/api/fleet/analytics?${params}`
+    return this.getJson(`${this.baseUrl}/api/fleet/analytics?${params}`, ANALYTICS_TTL_MS, options);
+  }
+
+  // Geofence polygons and the alert rules evaluated against them
+  public async getAlertConfig(options?: RequestOptions): Promise<AlertConfig> {
+    const data = await this.getJson<Partial<AlertConfig>>(
+      `${this.baseUrl}/api/fleet/geofences`, GEOFENCE_TTL_MS, options
     );
-    return response.json();
+    return { geofences: data.geofences || [], rules: data.rules || [] };
+  }
+
+  // `keepalive` lets the report posted while the page unloads still complete
+  public async postClientMetrics(report: ClientMetricsReport): Promise<void> {
+    await this.fetchWithAuth(`${this.baseUrl}/api/telemetry/client-metrics`, {
+      method: 'POST',
+      body: JSON.stringify(report),
+      keepalive: true
+    });
   }
 }
 
@@ -68,3 +161,18 @@ export interface FleetAnalytics {
   averageBattery: number;
   totalDistance: number;
 }
+
+export interface AlertConfig {
+  geofences: Geofence[];
+  rules: AlertRule[];
+}
+
+// Performance counters and histograms one browser collected over a reporting period
+export interface ClientMetricsReport {
+  clientId: string;
+  start: string; // ISO 8601
+  end: string;
+  // Totals over the period and per-second rates
+  counters: Record<string, { total: number; perSecond: number }>;
+  histograms: Record<string, HistogramSummary>;
+}
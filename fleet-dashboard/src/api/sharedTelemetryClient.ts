@@ -0,0 +1,177 @@
+import {
+  TelemetryClient,
+  TelemetryClientOptions,
+  MessageHandler,
+  ConnectionHandler,
+  ErrorHandler,
+  ClusterSummaryHandler
+} from './websocketClient';
+import { FleetCounts, IngestFocus, ViewportBounds } from '../types';
+import { FilterCriteria } from '../utils/filterIndex';
+import { unpackVehicleBatch, VehicleIdDictionary } from '../utils/telemetryCodec';
+import { mergeMetrics } from '../utils/perfMetrics';
+import { SharedTelemetryCommand, SharedTelemetryEvent } from '../workers/protocol';
+
+/**
+ * Telemetry client backed by a SharedWorker, so every open tab of the
+ * dashboard shares one socket, one parse and one vehicle table. Message
+ * handlers receive batches of full vehicle states, limited to the vehicles
+ * selected by the last `subscribeFilter` criteria; remove handlers are told
+ * which vehicles stopped being selected, and counts handlers receive the
+ * counters of the whole fleet.
+ */
+export type RemoveHandler = (vehicleIds: string[]) => void;
+export type FleetCountsHandler = (counts: FleetCounts) => void;
+
+export class SharedTelemetryClient implements TelemetryClient {
+  private worker: SharedWorker | null = null;
+  private url: string;
+  private token: string;
+  private options: TelemetryClientOptions;
+  private dictionary = new VehicleIdDictionary();
+  private criteria: FilterCriteria | null = null;
+  private viewport: ViewportBounds | null = null;
+  private focus: IngestFocus | null = null;
+  private messageHandlers: Set<MessageHandler> = new Set();
+  private connectionHandlers: Set<ConnectionHandler> = new Set();
+  private errorHandlers: Set<ErrorHandler> = new Set();
+  private clusterSummaryHandlers: Set<ClusterSummaryHandler> = new Set();
+  private removeHandlers: Set<RemoveHandler> = new Set();
+  private fleetCountsHandlers: Set<FleetCountsHandler> = new Set();
+  private visibilityListener = () => this.send({ type: 'visibility', hidden: document.hidden });
+  // Unmount cleanup does not run when a tab closes; tell the worker to drop the port.
+  // A page kept in the back/forward cache reconnects when it is shown again.
+  private pageHideListener = (event: PageTransitionEvent) => {
+    this.disconnect();
+    if (event.persisted) window.addEventListener('pageshow', this.pageShowListener);
+  };
+  private pageShowListener = (event: PageTransitionEvent) => {
+    if (event.persisted) this.connect();
+  };
+
+  constructor(url: string, token: string, options: TelemetryClientOptions = {}) {
+    this.url = url;
+    this.token = token;
+    this.options = options;
+  }
+
+  public connect(): void {
+    if (!this.worker) {
+      this.worker = new SharedWorker(new URL('../workers/sharedTelemetry.worker.ts', import.meta.url), {
+        type: 'module',
+        name: 'fleet-telemetry'
+      });
+      this.worker.port.onmessage = this.handleWorkerMessage.bind(this);
+      this.worker.onerror = (event) => {
+        console.error('Shared telemetry worker error:', event);
+        this.errorHandlers.forEach(handler =>
+          handler({ code: 'WORKER_ERROR', message: 'Shared telemetry worker error' })
+        );
+      };
+      this.worker.port.start();
+      document.addEventListener('visibilitychange', this.visibilityListener);
+      window.addEventListener('pagehide', this.pageHideListener);
+    }
+
+    window.removeEventListener('pageshow', this.pageShowListener);
+    this.dictionary = new VehicleIdDictionary();
+    if (this.criteria) this.send({ type: 'filter', criteria: this.criteria });
+    if (this.viewport) this.send({ type: 'viewport', viewport: this.viewport });
+    if (this.focus) this.send({ type: 'focus', focus: this.focus });
+    this.send({ type: 'connect', url: this.url, token: this.token, options: this.options });
+    this.visibilityListener();
+  }
+
+  public disconnect(): void {
+    window.removeEventListener('pageshow', this.pageShowListener);
+    if (this.worker) {
+      document.removeEventListener('visibilitychange', this.visibilityListener);
+      window.removeEventListener('pagehide', this.pageHideListener);
+      // Other tabs keep the socket; the worker closes it once no tab is left
+      this.send({ type: 'disconnect' });
+      this.worker.port.close();
+      this.worker = null;
+    }
+  }
+
+  public onMessage(handler: MessageHandler): () => void {
+    this.messageHandlers.add(handler);
+    return () => this.messageHandlers.delete(handler);
+  }
+
+  public onConnectionChange(handler: ConnectionHandler): () => void {
+    this.connectionHandlers.add(handler);
+    return () => this.connectionHandlers.delete(handler);
+  }
+
+  public onError(handler: ErrorHandler): () => void {
+    this.errorHandlers.add(handler);
+    return () => this.errorHandlers.delete(handler);
+  }
+
+  public onClusterSummary(handler: ClusterSummaryHandler): () => void {
+    this.clusterSummaryHandlers.add(handler);
+    return () => this.clusterSummaryHandlers.delete(handler);
+  }
+
+  public onRemove(handler: RemoveHandler): () => void {
+    this.removeHandlers.add(handler);
+    return () => this.removeHandlers.delete(handler);
+  }
+
+  public onFleetCounts(handler: FleetCountsHandler): () => void {
+    this.fleetCountsHandlers.add(handler);
+    return () => this.fleetCountsHandlers.delete(handler);
+  }
+
+  public subscribeViewport(viewport: ViewportBounds): void {
+    this.viewport = viewport;
+    this.send({ type: 'viewport', viewport });
+  }
+
+  public setFocus(focus: IngestFocus): void {
+    this.focus = focus;
+    this.send({ type: 'focus', focus });
+  }
+
+  // The worker answers with the vehicles to remove and the full state of the newly selected ones
+  public subscribeFilter(criteria: FilterCriteria): void {
+    this.criteria = {
+      status: criteria.status,
+      searchQuery: criteria.searchQuery,
+      lowBatteryOnly: criteria.lowBatteryOnly
+    };
+    this.send({ type: 'filter', criteria: this.criteria });
+  }
+
+  private handleWorkerMessage(event: MessageEvent<SharedTelemetryEvent>): void {
+    const message = event.data;
+    switch (message.type) {
+      case 'batch':
+        this.messageHandlers.forEach(handler => handler(unpackVehicleBatch(message.batch, this.dictionary)));
+        break;
+      case 'connection':
+        this.connectionHandlers.forEach(handler => handler(message.status));
+        break;
+      case 'clusters':
+        this.clusterSummaryHandlers.forEach(handler => handler(message.summaries));
+        break;
+      case 'error':
+        this.errorHandlers.forEach(handler => handler(message.error));
+        break;
+      case 'metrics':
+        mergeMetrics(message.metrics);
+        break;
+      case 'remove':
+        this.removeHandlers.forEach(handler => handler(message.vehicleIds));
+        break;
+      case 'counts':
+        this.fleetCountsHandlers.forEach(handler => handler(message.counts));
+        break;
+    }
+  }
+
+  private send(command: SharedTelemetryCommand): void {
+    this.worker?.port.postMessage(command);
+  }
+}
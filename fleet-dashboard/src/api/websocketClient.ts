@@ -1,15 +1,71 @@
-import { VehicleData, WebSocketMessage, ConnectionStatus } from '../types';
+import {
+  VehicleData,
+  VehicleUpdate,
+  VehiclePatch,
+  WebSocketMessage,
+  ConnectionStatus,
+  ViewportBounds,
+  ClusterSummary,
+  StreamCheckpoint,
+  CatchUpData,
+  IngestFocus
+} from '../types';
+import {
+  BINARY_SUBPROTOCOL,
+  JSON_SUBPROTOCOL,
+  FrameType,
+  decodeTelemetryFrame,
+  frameToVehicles
+} from '../utils/binaryFrame';
+import { VehicleIdDictionary } from '../utils/telemetryCodec';
+import { IngestFlowController, LoadShedder } from '../utils/ingestFlowControl';
+import { MOCK_SCHEME } from './mockUrl';
+import { PerfCounter, PerfHistogram, perfCount, perfMeasure, perfStart } from '../utils/perfMetrics';
 
-type MessageHandler = (data: VehicleData | VehicleData[]) => void;
-type ConnectionHandler = (status: ConnectionStatus) => void;
-type ErrorHandler = (error: ErrorData) => void;
+export type MessageHandler = (data: VehicleUpdate | VehicleUpdate[]) => void;
+export type PatchHandler = (patches: VehiclePatch[]) => void;
+export type ConnectionHandler = (status: ConnectionStatus) => void;
+export type ErrorHandler = (error: ErrorData) => void;
+export type ClusterSummaryHandler = (summaries: ClusterSummary[]) => void;
+export type StreamResetHandler = () => void;
 
-interface ErrorData {
+const MAX_RECONNECT_DELAY_MS = 30000;
+// Extra doublings of the backoff window when the server closes for a restart or overload,
+// so a fleet of dashboards spreads its reconnects over several seconds
+const RESTART_BACKOFF_STEPS = 3;
+// 1001 going away, 1012 service restart, 1013 try again later
+const RESTART_CLOSE_CODES = new Set([1001, 1012, 1013]);
+// Flow control period: lag is evaluated and held updates released this often
+const FLOW_CONTROL_INTERVAL_MS = 1000;
+// `mock:` stream URLs are served by the simulator only in dev and benchmark builds;
+// otherwise the simulator is compiled out of the bundle
+const MOCK_TELEMETRY = import.meta.env.DEV || import.meta.env.VITE_MOCK_TELEMETRY === 'true';
+
+export interface ErrorData {
   code: string;
   message: string;
 }
 
-export class TelemetryWebSocketClient {
+export interface TelemetryClientOptions {
+  // Offer the compact binary subprotocol; the server may still pick JSON
+  binary?: boolean;
+}
+
+// Common surface of every telemetry transport the app can mount
+export interface TelemetryClient {
+  connect(): void;
+  disconnect(): void;
+  onMessage(handler: MessageHandler): () => void;
+  onConnectionChange(handler: ConnectionHandler): () => void;
+  onError(handler: ErrorHandler): () => void;
+  onClusterSummary(handler: ClusterSummaryHandler): () => void;
+  // Narrows the stream to the visible map area; re-sent automatically after reconnects
+  subscribeViewport(viewport: ViewportBounds): void;
+  // What the user is looking at; decides which updates load shedding may delay
+  setFocus(focus: IngestFocus): void;
+}
+
+export class TelemetryWebSocketClient implements TelemetryClient {
   private ws: WebSocket | null = null;
   private url: string;
   private token: string;
@@ -18,35 +74,83 @@ export class TelemetryWebSocketClient {
   private reconnectDelay: number = 1000;
   private reconnectTimer: number | null = null;
   private messageHandlers: Set<MessageHandler> = new Set();
+  private patchHandlers: Set<PatchHandler> = new Set();
   private connectionHandlers: Set<ConnectionHandler> = new Set();
   private errorHandlers: Set<ErrorHandler> = new Set();
+  private clusterSummaryHandlers: Set<ClusterSummaryHandler> = new Set();
+  private streamResetHandlers: Set<StreamResetHandler> = new Set();
+  private viewport: ViewportBounds | null = null;
+  // Last stream position the server confirmed; sent as `resume` after a reconnect
+  private checkpoint: StreamCheckpoint | null = null;
+  private serverRestart: boolean = false;
   private pingInterval: number | null = null;
   private lastMessageTime: number = Date.now();
   private staleCheckInterval: number | null = null;
+  private flowControlInterval: number | null = null;
+  private flow = new IngestFlowController();
+  private shedder = new LoadShedder();
+  private shedding: boolean = false;
+  private lagMs: number = 0;
+  // Vehicle records received since the last flow control period
+  private periodUpdates: number = 0;
+  private periodStart: number = Date.now();
+  private options: TelemetryClientOptions;
+  private idDictionary = new VehicleIdDictionary();
+  // Records skipped on this connection for lack of a dictionary entry
+  private unknownSlots: number = 0;
+  // The last binary frame was part of a snapshot; later snapshot frames continue it
+  private inSnapshotFrames: boolean = false;
+  // Bumped by connect and disconnect, so a simulator that loads after either is dropped
+  private connectGeneration: number = 0;
 
-  constructor(url: string, token: string) {
+  constructor(url: string, token: string, options: TelemetryClientOptions = {}) {
     this.url = url;
     this.token = token;
+    this.options = options;
   }
 
   public connect(): void {
-    try {
-      const wsUrl = `${this.url}?token=${this.token}`;
-      this.ws = new WebSocket(wsUrl);
+    const generation = ++this.connectGeneration;
+    const wsUrl = `${this.url}?token=${this.token}`;
+    if (MOCK_TELEMETRY && wsUrl.startsWith(MOCK_SCHEME)) {
+      import('./mockTelemetrySocket')
+        .then(({ MockTelemetrySocket }) => {
+          if (generation === this.connectGeneration) this.attach(new MockTelemetrySocket(wsUrl) as unknown as WebSocket);
+        })
+        .catch((error) => {
+          console.error('Mock telemetry load error:', error);
+        });
+      return;
+    }
 
-      this.ws.onopen = this.handleOpen.bind(this);
-      this.ws.onmessage = this.handleMessage.bind(this);
-      this.ws.onerror = this.handleError.bind(this);
-      this.ws.onclose = this.handleClose.bind(this);
+    try {
+      this.attach(new WebSocket(wsUrl, this.options.binary ? [BINARY_SUBPROTOCOL, JSON_SUBPROTOCOL] : undefined));
     } catch (error) {
       console.error('WebSocket connection error:', error);
       this.handleReconnect();
     }
   }
 
+  private attach(ws: WebSocket): void {
+    this.ws = ws;
+    this.ws.binaryType = 'arraybuffer';
+
+    this.ws.onopen = this.handleOpen.bind(this);
+    this.ws.onmessage = this.handleMessage.bind(this);
+    this.ws.onerror = this.handleError.bind(this);
+    this.ws.onclose = this.handleClose.bind(this);
+  }
+
   public disconnect(): void {
+    this.connectGeneration++;
     this.clearTimers();
+    this.shedder.clear();
     if (this.ws) {
+      // Detached first: the close event arrives later and must not schedule a reconnect
+      this.ws.onopen = null;
+      this.ws.onmessage = null;
+      this.ws.onerror = null;
+      this.ws.onclose = null;
       this.ws.close();
       this.ws = null;
     }
@@ -58,59 +162,201 @@ export class TelemetryWebSocketClient {
     return () => this.messageHandlers.delete(handler);
   }
 
+  // Patches are delivered raw; sequencing and merging is left to VehicleUpdateBatcher
+  public onPatch(handler: PatchHandler): () => void {
+    this.patchHandlers.add(handler);
+    return () => this.patchHandlers.delete(handler);
+  }
+
+  // Fired before a snapshot that replaces the stream's history, e.g. after an epoch change;
+  // per-vehicle sequence numbers restart, so consumers must drop the ones they hold
+  public onStreamReset(handler: StreamResetHandler): () => void {
+    this.streamResetHandlers.add(handler);
+    return () => this.streamResetHandlers.delete(handler);
+  }
+
   public onConnectionChange(handler: ConnectionHandler): () => void {
     this.connectionHandlers.add(handler);
     return () => this.connectionHandlers.delete(handler);
   }
 
+  // Asks the server to resend full snapshots for vehicles whose patch stream broke
+  public requestResync(vehicleIds: string[]): void {
+    if (this.ws && this.ws.readyState === WebSocket.OPEN) {
+      this.ws.send(JSON.stringify({ type: 'resync', vehicleIds }));
+    }
+  }
+
   public onError(handler: ErrorHandler): () => void {
     this.errorHandlers.add(handler);
     return () => this.errorHandlers.delete(handler);
   }
 
+  public onClusterSummary(handler: ClusterSummaryHandler): () => void {
+    this.clusterSummaryHandlers.add(handler);
+    return () => this.clusterSummaryHandlers.delete(handler);
+  }
+
+  public subscribeViewport(viewport: ViewportBounds): void {
+    this.viewport = viewport;
+    this.sendSubscribe();
+  }
+
+  public setFocus(focus: IngestFocus): void {
+    this.shedder.setFocus(focus);
+  }
+
   private handleOpen(): void {
-    console.log('WebSocket connected');
+    console.log('WebSocket connected', this.ws?.protocol || '');
     this.reconnectAttempts = 0;
+    // Slot dictionaries are scoped to a single connection
+    this.idDictionary.clear();
+    this.unknownSlots = 0;
+    this.inSnapshotFrames = false;
     this.lastMessageTime = Date.now();
+    // The new connection starts with an empty socket buffer and no server-side throttle
+    this.flow.reset();
+    this.shedding = false;
+    this.lagMs = 0;
+    this.periodUpdates = 0;
+    this.periodStart = Date.now();
+    this.emitVehicles(this.shedder.setActive(false, Date.now()));
+    this.sendResume();
+    this.sendSubscribe();
     this.notifyConnectionChange({
       connected: true,
       reconnecting: false,
       lastUpdate: Date.now(),
-      stale: false
+      stale: false,
+      shedding: false,
+      lagMs: 0
     });
 
     // Start ping to keep connection alive
-    this.pingInterval = window.setInterval(() => {
+    this.pingInterval = setInterval(() => {
       if (this.ws && this.ws.readyState === WebSocket.OPEN) {
         this.ws.send(JSON.stringify({ type: 'ping' }));
       }
     }, 30000); // Ping every 30 seconds
 
     // Check for stale connection (no messages for >10s)
-    this.staleCheckInterval = window.setInterval(() => {
-      const timeSinceLastMessage = Date.now() - this.lastMessageTime;
-      const isStale = timeSinceLastMessage > 10000;
-      
-      this.notifyConnectionChange({
-        connected: this.ws?.readyState === WebSocket.OPEN || false,
-        reconnecting: false,
-        lastUpdate: this.lastMessageTime,
-        stale: isStale
+    this.staleCheckInterval = setInterval(() => this.notifyStreamStatus(), 5000); // Check every 5 seconds
+
+    this.flowControlInterval = setInterval(() => this.controlFlow(), FLOW_CONTROL_INTERVAL_MS);
+  }
+
+  private notifyStreamStatus(): void {
+    const timeSinceLastMessage = Date.now() - this.lastMessageTime;
+    const isStale = timeSinceLastMessage > 10000;
+
+    this.notifyConnectionChange({
+      connected: this.ws?.readyState === WebSocket.OPEN || false,
+      reconnecting: false,
+      lastUpdate: this.lastMessageTime,
+      stale: isStale,
+      shedding: this.shedding,
+      lagMs: this.lagMs
+    });
+  }
+
+  // Asks the server to slow down while behind, and sheds locally until caught up
+  private controlFlow(): void {
+    const now = Date.now();
+    const seconds = Math.max(0.001, (now - this.periodStart) / 1000);
+    const decision = this.flow.evaluate(now, this.periodUpdates / seconds);
+    this.periodUpdates = 0;
+    this.periodStart = now;
+    this.lagMs = decision.lagMs;
+
+    if (decision.throttleChanged && this.ws && this.ws.readyState === WebSocket.OPEN) {
+      this.ws.send(JSON.stringify({
+        type: 'throttle',
+        maxUpdatesPerSecond: decision.maxUpdatesPerSecond,
+        lagMs: Math.round(decision.lagMs)
+      }));
+    }
+
+    if (decision.shedding !== this.shedding) {
+      this.shedding = decision.shedding;
+      console.log(decision.shedding
+        ? `Ingest ${Math.round(decision.lagMs)}ms behind, shedding off-screen updates`
+        : 'Ingest caught up, shedding stopped');
+      this.emitVehicles(this.shedder.setActive(decision.shedding, now));
+      this.notifyStreamStatus();
+    } else if (this.shedding) {
+      this.emitVehicles(this.shedder.release(now));
+    }
+  }
+
+  // Vehicle records from the stream, minus those load shedding holds back for now
+  private deliver(vehicles: VehicleData | VehicleData[]): void {
+    const records = Array.isArray(vehicles) ? vehicles : [vehicles];
+    this.periodUpdates += records.length;
+    if (!this.shedding) {
+      this.messageHandlers.forEach(handler => handler(vehicles));
+      return;
+    }
+    const immediate = this.shedder.admit(records);
+    perfCount(PerfCounter.DEFERRED, records.length - immediate.length);
+    this.emitVehicles(immediate);
+  }
+
+  private emitVehicles(updates: VehicleUpdate[]): void {
+    if (updates.length > 0) this.messageHandlers.forEach(handler => handler(updates));
+  }
+
+  // A patch must land on the vehicle's latest full record, so a held one goes out first
+  private deliverPatches(patches: VehiclePatch[]): void {
+    if (this.shedder.deferred > 0) {
+      const held: VehicleUpdate[] = [];
+      patches.forEach(patch => {
+        const update = this.shedder.take(patch.id);
+        if (update) held.push(update);
       });
-    }, 5000); // Check every 5 seconds
+      this.emitVehicles(held);
+    }
+    this.patchHandlers.forEach(handler => handler(patches));
   }
 
   private handleMessage(event: MessageEvent): void {
+    perfCount(PerfCounter.MESSAGES);
+    if (event.data instanceof ArrayBuffer) {
+      perfCount(PerfCounter.BYTES, event.data.byteLength);
+      this.handleBinaryMessage(event.data);
+      return;
+    }
+
     try {
+      // UTF-16 length; equals the byte count for ASCII JSON
+      perfCount(PerfCounter.BYTES, event.data.length);
+      const parseStart = perfStart();
       const message: WebSocketMessage = JSON.parse(event.data);
+      perfMeasure(PerfHistogram.PARSE, parseStart);
       this.lastMessageTime = Date.now();
+      if (message.timestamp) this.flow.observe(Date.parse(message.timestamp), this.lastMessageTime);
 
       switch (message.type) {
         case 'vehicle_update':
-          this.messageHandlers.forEach(handler => handler(message.data as VehicleData));
+          this.deliver(message.data as VehicleData);
           break;
         case 'batch_update':
-          this.messageHandlers.forEach(handler => handler(message.data as VehicleData[]));
+          this.deliver(message.data as VehicleData[]);
+          break;
+        case 'vehicle_patch': {
+          const patches = Array.isArray(message.data)
+            ? message.data as VehiclePatch[]
+            : [message.data as VehiclePatch];
+          this.deliverPatches(patches);
+          break;
+        }
+        case 'cluster_summary':
+          this.clusterSummaryHandlers.forEach(handler => handler(message.data as ClusterSummary[]));
+          break;
+        case 'checkpoint':
+          this.advanceCheckpoint(message.data as StreamCheckpoint);
+          break;
+        case 'catch_up':
+          this.handleCatchUp(message.data as CatchUpData);
           break;
         case 'error':
           this.errorHandlers.forEach(handler => handler(message.data as ErrorData));
@@ -124,6 +370,68 @@ export class TelemetryWebSocketClient {
     }
   }
 
+  // Deltas go through the normal paths, so patch sequencing carries on from before the drop;
+  // a snapshot first resets sequencing, then its full records re-base every vehicle it contains
+  private handleCatchUp(catchUp: CatchUpData): void {
+    if (catchUp.mode === 'snapshot') {
+      this.resetStream();
+      this.checkpoint = catchUp.checkpoint;
+    } else {
+      this.advanceCheckpoint(catchUp.checkpoint);
+    }
+    if (catchUp.vehicles && catchUp.vehicles.length > 0) {
+      const vehicles = catchUp.vehicles;
+      this.messageHandlers.forEach(handler => handler(vehicles));
+    }
+    if (catchUp.patches && catchUp.patches.length > 0) {
+      const patches = catchUp.patches;
+      this.patchHandlers.forEach(handler => handler(patches));
+    }
+  }
+
+  // A new epoch means the server lost its history and sequence numbers start over
+  private advanceCheckpoint(checkpoint: StreamCheckpoint): void {
+    if (this.checkpoint && this.checkpoint.epoch !== checkpoint.epoch) this.resetStream();
+    this.checkpoint = checkpoint;
+  }
+
+  // Held updates belong to the old sequence and would shadow the new one if released later
+  private resetStream(): void {
+    this.shedder.clear();
+    this.streamResetHandlers.forEach(handler => handler());
+  }
+
+  private handleBinaryMessage(buffer: ArrayBuffer): void {
+    try {
+      const parseStart = perfStart();
+      const frame = decodeTelemetryFrame(buffer, this.idDictionary);
+      this.lastMessageTime = Date.now();
+      // A run of snapshot frames is one snapshot: reset once, at its first frame
+      const snapshot = frame.type === FrameType.SNAPSHOT;
+      if (snapshot && !this.inSnapshotFrames) this.resetStream();
+      this.inSnapshotFrames = snapshot;
+      const vehicles = frameToVehicles(frame, this.idDictionary);
+      perfMeasure(PerfHistogram.PARSE, parseStart);
+      if (vehicles.length < frame.count) this.countUnknownSlots(frame.count - vehicles.length);
+      // Binary frames carry no send time; the newest record in the frame stands in for it
+      let newest = 0;
+      for (let i = 0; i < frame.timestampDelta.length; i++) newest = Math.max(newest, frame.timestampDelta[i]);
+      if (vehicles.length > 0) this.flow.observe(frame.baseTimestamp + newest, this.lastMessageTime);
+      this.deliver(vehicles);
+    } catch (error) {
+      console.error('Failed to decode binary telemetry frame:', error);
+    }
+  }
+
+  // The server referenced slots it never sent entries for; those records cannot be attributed
+  private countUnknownSlots(count: number): void {
+    perfCount(PerfCounter.UNKNOWN_SLOTS, count);
+    if (this.unknownSlots === 0) {
+      console.warn(`Skipped ${count} binary telemetry records with no dictionary entry on this connection`);
+    }
+    this.unknownSlots += count;
+  }
+
   private handleError(event: Event): void {
     console.error('WebSocket error:', event);
     this.errorHandlers.forEach(handler => 
@@ -131,14 +439,17 @@ export class TelemetryWebSocketClient {
     );
   }
 
-  private handleClose(): void {
-    console.log('WebSocket closed');
+  private handleClose(event: CloseEvent): void {
+    console.log('WebSocket closed', event.code);
+    this.serverRestart = RESTART_CLOSE_CODES.has(event.code);
     this.clearTimers();
     this.notifyConnectionChange({
       connected: false,
       reconnecting: this.reconnectAttempts < this.maxReconnectAttempts,
       lastUpdate: this.lastMessageTime,
-      stale: true
+      stale: true,
+      shedding: false,
+      lagMs: 0
     });
     this.handleReconnect();
   }
@@ -153,10 +464,11 @@ export class TelemetryWebSocketClient {
     }
 
     this.reconnectAttempts++;
-    const delay = Math.min(
-      this.reconnectDelay * Math.pow(2, this.reconnectAttempts - 1),
-      30000
-    );
+    // Full jitter: a uniform delay below the exponential ceiling, so clients dropped
+    // together do not come back together
+    const steps = this.reconnectAttempts - 1 + (this.serverRestart ? RESTART_BACKOFF_STEPS : 0);
+    const ceiling = Math.min(this.reconnectDelay * Math.pow(2, steps), MAX_RECONNECT_DELAY_MS);
+    const delay = Math.round(Math.random() * ceiling);
 
     console.log(`Reconnecting in ${delay}ms (attempt ${this.reconnectAttempts}/${this.maxReconnectAttempts})`);
     
@@ -164,14 +476,31 @@ export class TelemetryWebSocketClient {
       connected: false,
       reconnecting: true,
       lastUpdate: this.lastMessageTime,
-      stale: true
+      stale: true,
+      shedding: false,
+      lagMs: 0
     });
 
-    this.reconnectTimer = window.setTimeout(() => {
+    this.reconnectTimer = setTimeout(() => {
       this.connect();
     }, delay);
   }
 
+  // Asks for the changes since the last checkpoint; the server answers with `catch_up`
+  private sendResume(): void {
+    if (this.checkpoint && this.ws && this.ws.readyState === WebSocket.OPEN) {
+      this.ws.send(JSON.stringify({ type: 'resume', ...this.checkpoint }));
+    }
+  }
+
+  // The server thins out updates outside these bounds and sends cluster summaries at low zoom
+  private sendSubscribe(): void {
+    if (this.viewport && this.ws && this.ws.readyState === WebSocket.OPEN) {
+      const { south, west, north, east, zoom } = this.viewport;
+      this.ws.send(JSON.stringify({ type: 'subscribe', bounds: { south, west, north, east }, zoom }));
+    }
+  }
+
   private notifyConnectionChange(status: ConnectionStatus): void {
     this.connectionHandlers.forEach(handler => handler(status));
   }
@@ -189,5 +518,9 @@ export class TelemetryWebSocketClient {
       clearInterval(this.staleCheckInterval);
       this.staleCheckInterval = null;
     }
+    if (this.flowControlInterval) {
+      clearInterval(this.flowControlInterval);
+      this.flowControlInterval = null;
+    }
   }
 }
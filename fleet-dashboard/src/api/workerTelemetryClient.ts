@@ -0,0 +1,124 @@
+import {
+  TelemetryClient,
+  TelemetryClientOptions,
+  MessageHandler,
+  ConnectionHandler,
+  ErrorHandler,
+  ClusterSummaryHandler
+} from './websocketClient';
+import { IngestFocus, ViewportBounds } from '../types';
+import { unpackVehicleBatch, VehicleIdDictionary } from '../utils/telemetryCodec';
+import { mergeMetrics } from '../utils/perfMetrics';
+import { TelemetryWorkerCommand, TelemetryWorkerEvent } from '../workers/protocol';
+
+/**
+ * Telemetry client that runs the WebSocket, parsing and coalescing in a
+ * dedicated worker. Message handlers receive one already-coalesced batch per
+ * frame, so callers do not need a main-thread batcher.
+ */
+export class WorkerTelemetryClient implements TelemetryClient {
+  private worker: Worker | null = null;
+  private url: string;
+  private token: string;
+  private options: TelemetryClientOptions;
+  private dictionary = new VehicleIdDictionary();
+  private messageHandlers: Set<MessageHandler> = new Set();
+  private connectionHandlers: Set<ConnectionHandler> = new Set();
+  private errorHandlers: Set<ErrorHandler> = new Set();
+  private clusterSummaryHandlers: Set<ClusterSummaryHandler> = new Set();
+  private visibilityListener = () => this.send({ type: 'visibility', hidden: document.hidden });
+
+  constructor(url: string, token: string, options: TelemetryClientOptions = {}) {
+    this.url = url;
+    this.token = token;
+    this.options = options;
+  }
+
+  public connect(): void {
+    if (!this.worker) {
+      this.worker = new Worker(new URL('../workers/telemetry.worker.ts', import.meta.url), {
+        type: 'module'
+      });
+      this.worker.onmessage = this.handleWorkerMessage.bind(this);
+      this.worker.onerror = (event) => {
+        console.error('Telemetry worker error:', event);
+        this.errorHandlers.forEach(handler =>
+          handler({ code: 'WORKER_ERROR', message: event.message || 'Telemetry worker error' })
+        );
+      };
+      document.addEventListener('visibilitychange', this.visibilityListener);
+    }
+
+    this.dictionary = new VehicleIdDictionary();
+    this.send({ type: 'connect', url: this.url, token: this.token, options: this.options });
+    this.visibilityListener();
+  }
+
+  public disconnect(): void {
+    if (this.worker) {
+      document.removeEventListener('visibilitychange', this.visibilityListener);
+      this.send({ type: 'disconnect' });
+      this.worker.terminate();
+      this.worker = null;
+    }
+  }
+
+  public onMessage(handler: MessageHandler): () => void {
+    this.messageHandlers.add(handler);
+    return () => this.messageHandlers.delete(handler);
+  }
+
+  public onConnectionChange(handler: ConnectionHandler): () => void {
+    this.connectionHandlers.add(handler);
+    return () => this.connectionHandlers.delete(handler);
+  }
+
+  public onError(handler: ErrorHandler): () => void {
+    this.errorHandlers.add(handler);
+    return () => this.errorHandlers.delete(handler);
+  }
+
+  public onClusterSummary(handler: ClusterSummaryHandler): () => void {
+    this.clusterSummaryHandlers.add(handler);
+    return () => this.clusterSummaryHandlers.delete(handler);
+  }
+
+  public subscribeViewport(viewport: ViewportBounds): void {
+    this.send({ type: 'viewport', viewport });
+  }
+
+  public setFocus(focus: IngestFocus): void {
+    this.send({ type: 'focus', focus });
+  }
+
+  private handleWorkerMessage(event: MessageEvent<TelemetryWorkerEvent>): void {
+    const message = event.data;
+    switch (message.type) {
+      case 'batch': {
+        // Records coalesced from patches only carry the fields that changed
+        const start = performance.now();
+        const updates = unpackVehicleBatch(message.batch, this.dictionary);
+        this.messageHandlers.forEach(handler => handler(updates));
+        // Lets the worker's frame scheduler back off when applying batches gets expensive
+        this.send({ type: 'commit', durationMs: performance.now() - start });
+        break;
+      }
+      case 'connection':
+        this.connectionHandlers.forEach(handler => handler(message.status));
+        break;
+      case 'clusters':
+        this.clusterSummaryHandlers.forEach(handler => handler(message.summaries));
+        break;
+      case 'error':
+        this.errorHandlers.forEach(handler => handler(message.error));
+        break;
+      case 'metrics':
+        mergeMetrics(message.metrics);
+        break;
+    }
+  }
+
+  private send(command: TelemetryWorkerCommand): void {
+    this.worker?.postMessage(command);
+  }
+}
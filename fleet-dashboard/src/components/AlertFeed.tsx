@@ -0,0 +1,79 @@
+import { useState } from 'react';
+import { format } from 'date-fns';
+import { useFleetStore } from '../stores/fleetStore';
+import { AlertType } from '../types';
+
+const ALERT_COLORS: Record<AlertType, string> = {
+  [AlertType.ENTER]: 'bg-blue-500',
+  [AlertType.EXIT]: 'bg-orange-500',
+  [AlertType.SPEED_IN_ZONE]: 'bg-red-500',
+  [AlertType.STALE]: 'bg-gray-400'
+};
+
+// Header button with the rules engine's alerts; selecting one selects its vehicle
+function AlertFeed() {
+  const [open, setOpen] = useState(false);
+  const alerts = useFleetStore(state => state.alerts);
+  const selectVehicle = useFleetStore(state => state.selectVehicle);
+  const dismissAlert = useFleetStore(state => state.dismissAlert);
+  const clearAlerts = useFleetStore(state => state.clearAlerts);
+
+  return (
+    <div className="relative">
+      <button
+        onClick={() => setOpen(!open)}
+        aria-expanded={open}
+        className={`px-3 py-1.5 text-sm font-medium rounded-lg transition-colors ${
+          open ? 'bg-fleet-primary text-white' : 'bg-gray-100 text-gray-700 hover:bg-gray-200'
+        }`}
+      >
+        Alerts
+        {alerts.length > 0 && (
+          <span className="ml-2 px-1.5 rounded-full bg-red-500 text-white text-xs tabular-nums">
+            {alerts.length}
+          </span>
+        )}
+      </button>
+
+      {open && (
+        <div
+          className="absolute right-0 mt-2 z-[1100] w-96 max-h-96 overflow-y-auto bg-white rounded-lg shadow-lg border border-gray-200"
+          role="region"
+          aria-label="Fleet alerts"
+        >
+          <div className="flex items-center justify-between px-3 py-2 border-b border-gray-200 text-xs text-gray-500">
+            <span>{alerts.length === 0 ? 'No alerts' : `${alerts.length} alerts, newest first`}</span>
+            {alerts.length > 0 && (
+              <button onClick={clearAlerts} className="hover:text-gray-700">
+                Clear all
+              </button>
+            )}
+          </div>
+          <ul className="divide-y divide-gray-100">
+            {alerts.map(alert => (
+              <li key={alert.id} className="flex items-start gap-2 px-3 py-2 text-sm hover:bg-gray-50">
+                <span className={`mt-1.5 w-2 h-2 rounded-full flex-shrink-0 ${ALERT_COLORS[alert.type]}`} />
+                <button
+                  onClick={() => selectVehicle(alert.vehicleId)}
+                  className="flex-1 text-left text-gray-800"
+                >
+                  {alert.message}
+                  <span className="block text-xs text-gray-500">{format(alert.time, 'HH:mm:ss')}</span>
+                </button>
+                <button
+                  onClick={() => dismissAlert(alert.id)}
+                  aria-label="Dismiss alert"
+                  className="text-gray-400 hover:text-gray-600"
+                >
+                  ×
+                </button>
+              </li>
+            ))}
+          </ul>
+        </div>
+      )}
+    </div>
+  );
+}
+
+export default AlertFeed;
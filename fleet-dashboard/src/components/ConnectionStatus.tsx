@@ -1,10 +1,10 @@
-import { useFleetStore } from '../stores/fleetStore';
+import { useFleetStore, fleetCountsOf } from '../stores/fleetStore';
 import { formatDistanceToNow } from 'date-fns';
 
 function ConnectionStatus() {
   const connectionStatus = useFleetStore(state => state.connectionStatus);
   const onlineCount = useFleetStore(state => state.getOnlineCount());
-  const totalCount = useFleetStore(state => state.vehicles.size);
+  const totalCount = useFleetStore(state => fleetCountsOf(state).total);
 
   const getStatusColor = () => {
     if (!connectionStatus.connected) return 'bg-red-500';
@@ -71,6 +71,18 @@ function ConnectionStatus() {
         </div>
       </div>
 
+      {/* Load shedding: off-screen and clustered vehicles update less often until the client catches up */}
+      {connectionStatus.connected && connectionStatus.shedding && (
+        <div
+          className="flex items-center gap-1.5 px-2.5 py-1 rounded-full bg-yellow-100 text-xs font-medium text-yellow-800"
+          title="Behind the live stream: off-screen and clustered vehicles update less often until the dashboard catches up"
+        >
+          <div className="w-1.5 h-1.5 rounded-full bg-yellow-500" />
+          Shedding
+          <span className="tabular-nums">· {(connectionStatus.lagMs / 1000).toFixed(1)}s behind</span>
+        </div>
+      )}
+
       {/* Last Update Time */}
       {connectionStatus.lastUpdate > 0 && (
         <div className="text-xs text-gray-500 hidden md:block">
@@ -1,10 +1,32 @@
-import { useFleetStore } from '../stores/fleetStore';
-import { VehicleStatus, TimeRange } from '../types';
+import { useEffect, useState, startTransition } from 'react';
+import { useFleetStore, fleetCountsOf } from '../stores/fleetStore';
+import { VehicleStatus, TimeRange, SortField } from '../types';
+
+// Idle time after the last keystroke before the search query is applied
+const SEARCH_DEBOUNCE_MS = 150;
 
 function FilterControls() {
   const filters = useFleetStore(state => state.filters);
   const setFilter = useFleetStore(state => state.setFilter);
+  const [searchInput, setSearchInput] = useState(filters.searchQuery);
+
+  // Follow the committed query when it changes elsewhere
+  useEffect(() => {
+    setSearchInput(filters.searchQuery);
+  }, [filters.searchQuery]);
+
+  // Each keystroke cancels the pending query; the commit runs as a transition so
+  // re-filtering a large fleet never blocks typing
+  useEffect(() => {
+    if (searchInput === filters.searchQuery) return;
+    const timer = setTimeout(() => {
+      startTransition(() => setFilter('searchQuery', searchInput));
+    }, SEARCH_DEBOUNCE_MS);
+    return () => clearTimeout(timer);
+  }, [searchInput, filters.searchQuery, setFilter]);
   const lowBatteryCount = useFleetStore(state => state.getLowBatteryCount());
+  const statusCounts = useFleetStore(state => fleetCountsOf(state).byStatus);
+  const totalCount = useFleetStore(state => fleetCountsOf(state).total);
 
   return (
     <div className="space-y-4" role="search" aria-label="Filter vehicles">
@@ -25,11 +47,11 @@ function FilterControls() {
           className="w-full px-3 py-2 border border-gray-300 rounded-lg focus:ring-2 focus:ring-fleet-primary focus:border-fleet-primary"
           aria-label="Filter by vehicle status"
         >
-          <option value="all">All Vehicles</option>
-          <option value={VehicleStatus.ONLINE}>Online</option>
-          <option value={VehicleStatus.MOVING}>Moving</option>
-          <option value={VehicleStatus.STOPPED}>Stopped</option>
-          <option value={VehicleStatus.OFFLINE}>Offline</option>
+          <option value="all">All Vehicles ({totalCount})</option>
+          <option value={VehicleStatus.ONLINE}>Online ({statusCounts[VehicleStatus.ONLINE]})</option>
+          <option value={VehicleStatus.MOVING}>Moving ({statusCounts[VehicleStatus.MOVING]})</option>
+          <option value={VehicleStatus.STOPPED}>Stopped ({statusCounts[VehicleStatus.STOPPED]})</option>
+          <option value={VehicleStatus.OFFLINE}>Offline ({statusCounts[VehicleStatus.OFFLINE]})</option>
         </select>
       </div>
 
@@ -45,11 +67,21 @@ function FilterControls() {
           id="search-input"
           type="text"
           placeholder="Search by Vehicle ID..."
-          value={filters.searchQuery}
-          onChange={(e) => setFilter('searchQuery', e.target.value)}
+          value={searchInput}
+          onChange={(e) => setSearchInput(e.target.value)}
+          onKeyDown={(e) => {
+            if (e.key === 'Escape') {
+              setSearchInput('');
+              setFilter('searchQuery', '');
+            }
+          }}
           className="w-full px-3 py-2 border border-gray-300 rounded-lg focus:ring-2 focus:ring-fleet-primary focus:border-fleet-primary"
           aria-label="Search vehicles by ID"
+          aria-describedby="search-help"
         />
+        <p id="search-help" className="text-xs text-gray-500 mt-1">
+          e.g. <code>VEH-01 status:moving battery&lt;15 speed&gt;60</code>, <code>~veh12</code> for fuzzy
+        </p>
       </div>
 
       {/* Low Battery Filter */}
@@ -102,6 +134,38 @@ function FilterControls() {
           ))}
         </div>
       </div>
+
+      {/* Sort Order */}
+      <div>
+        <label
+          htmlFor="sort-field"
+          className="block text-sm font-medium text-gray-700 mb-1"
+        >
+          Sort By
+        </label>
+        <div className="flex gap-2">
+          <select
+            id="sort-field"
+            value={filters.sortBy}
+            onChange={(e) => setFilter('sortBy', e.target.value as SortField)}
+            className="flex-1 px-3 py-2 border border-gray-300 rounded-lg focus:ring-2 focus:ring-fleet-primary focus:border-fleet-primary"
+            aria-label="Sort vehicles by"
+          >
+            <option value={SortField.NONE}>Arrival order</option>
+            <option value={SortField.BATTERY}>Battery</option>
+            <option value={SortField.SPEED}>Speed</option>
+            <option value={SortField.LAST_UPDATE}>Last update</option>
+          </select>
+          <button
+            onClick={() => setFilter('sortDirection', filters.sortDirection === 'asc' ? 'desc' : 'asc')}
+            disabled={filters.sortBy === SortField.NONE}
+            className="px-3 py-2 text-sm font-medium rounded-lg bg-gray-100 text-gray-700 hover:bg-gray-200 disabled:opacity-50 transition-colors"
+            aria-label={`Sort ${filters.sortDirection === 'asc' ? 'ascending' : 'descending'}, click to reverse`}
+          >
+            {filters.sortDirection === 'asc' ? '↑ Asc' : '↓ Desc'}
+          </button>
+        </div>
+      </div>
     </div>
   );
 }
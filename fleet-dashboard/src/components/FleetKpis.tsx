@@ -0,0 +1,101 @@
+import { memo, useMemo } from 'react';
+import { Chart as ChartJS, LineElement, PointElement, LinearScale, ChartData, ChartOptions } from 'chart.js';
+import { Line } from 'react-chartjs-2';
+import { useFleetStore } from '../stores/fleetStore';
+import { useFleetAnalytics } from '../hooks/useFleetAnalytics';
+import { RollupPoint } from '../utils/fleetAnalytics';
+
+ChartJS.register(LineElement, PointElement, LinearScale);
+
+const SPARKLINE_OPTIONS: ChartOptions<'line'> = {
+  animation: false,
+  parsing: false,
+  normalized: true,
+  maintainAspectRatio: false,
+  events: [],
+  elements: { point: { radius: 0 }, line: { borderWidth: 1.5, tension: 0.3 } },
+  scales: { x: { type: 'linear', display: false }, y: { display: false } },
+  plugins: { legend: { display: false }, tooltip: { enabled: false } }
+};
+
+type RollupField = 'averageSpeed' | 'averageBattery' | 'moving' | 'distanceKm';
+
+// Rollup bucket means for the selected time range, drawn without axes
+const Sparkline = memo(({ points, field }: { points: RollupPoint[]; field: RollupField }) => {
+  const data = useMemo<ChartData<'line', Array<{ x: number; y: number }>>>(() => ({
+    datasets: [{
+      data: points.map(point => ({ x: point.time, y: point[field] })),
+      borderColor: '#2563eb'
+    }]
+  }), [points, field]);
+
+  if (points.length < 2) return <div className="h-8" />;
+  return (
+    <div className="h-8">
+      <Line data={data} options={SPARKLINE_OPTIONS} />
+    </div>
+  );
+});
+
+Sparkline.displayName = 'Sparkline';
+
+interface KpiTileProps {
+  label: string;
+  value: string;
+  detail: string;
+  points: RollupPoint[];
+  field: RollupField;
+}
+
+function KpiTile({ label, value, detail, points, field }: KpiTileProps) {
+  return (
+    <div className="rounded-lg border border-gray-200 px-3 py-2">
+      <div className="text-xs text-gray-500">{label}</div>
+      <div className="text-lg font-semibold text-gray-900 tabular-nums">{value}</div>
+      <div className="text-xs text-gray-500 tabular-nums">{detail}</div>
+      <Sparkline points={points} field={field} />
+    </div>
+  );
+}
+
+// Fleet KPIs computed from the live stream; sparklines follow the time range filter
+function FleetKpis() {
+  const kpis = useFleetAnalytics();
+  const timeRange = useFleetStore(state => state.filters.timeRange);
+  const points = kpis.rollups[timeRange];
+
+  return (
+    <section className="grid grid-cols-2 gap-2" aria-label="Fleet statistics">
+      <KpiTile
+        label="Online"
+        value={`${kpis.onlineVehicles.toLocaleString()} / ${kpis.totalVehicles.toLocaleString()}`}
+        detail={`${kpis.movingVehicles.toLocaleString()} moving`}
+        points={points}
+        field="moving"
+      />
+      <KpiTile
+        label="Average speed"
+        value={`${kpis.averageSpeed.toFixed(1)} km/h`}
+        detail={`σ ${kpis.speedStdDev.toFixed(1)} · max 5 min ${kpis.lastFiveMinutes.maxSpeed.toFixed(0)}`}
+        points={points}
+        field="averageSpeed"
+      />
+      <KpiTile
+        label="Average battery"
+        value={`${kpis.averageBattery.toFixed(0)}%`}
+        detail={`${kpis.lowBatteryVehicles.toLocaleString()} low`}
+        points={points}
+        field="averageBattery"
+      />
+      <KpiTile
+        label="Distance, last hour"
+        value={`${kpis.lastHour.distanceKm.toFixed(0)} km`}
+        detail={`${kpis.lastFiveMinutes.distanceKm.toFixed(1)} km in 5 min`}
+        points={points}
+        field="distanceKm"
+      />
+    </section>
+  );
+}
+
+export default FleetKpis;
@@ -1,11 +1,34 @@
-import { useEffect, useRef, memo } from 'react';
-import { MapContainer, TileLayer, Marker, Popup, useMap } from 'react-leaflet';
-import MarkerClusterGroup from 'react-leaflet-cluster';
+import { useEffect, useRef, useState } from 'react';
+import { MapContainer, TileLayer, Marker, useMap } from 'react-leaflet';
 import L from 'leaflet';
-import { useFleetStore } from '../stores/fleetStore';
-import { VehicleData, VehicleStatus } from '../types';
+import { useFleetStore, subscribeVehicleDeltas } from '../stores/fleetStore';
+import { ClusterSummary, GeoBounds } from '../types';
+import { WebGLVehicleLayer } from './map/WebGLVehicleLayer';
+import { ClusterMarkerLayer } from './map/ClusterMarkerLayer';
+import { ClusterIndexClient } from './map/ClusterIndexClient';
+import { getClusterIcon } from './map/vehicleIcons';
+import { bindLayerToStore } from './map/bindLayerToStore';
+import { sameFilterCriteria } from '../utils/filterIndex';
+import { FleetBoundsTracker } from './map/FleetBoundsTracker';
+import { TrailTracker } from './map/TrailTracker';
+import { TrailLayer } from './map/TrailLayer';
+import { LatencySampler } from '../utils/perfMetrics';
 import 'leaflet/dist/leaflet.css';
 
+// 'markers' draws clusters and vehicles queried from the worker cluster index; 'webgl' draws all vehicles as GPU points
+const MAP_RENDERER = import.meta.env.VITE_MAP_RENDERER || 'markers';
+// Materialize only vehicles inside the padded viewport and report it to the socket subscription
+const VIEWPORT_CULLING = import.meta.env.VITE_VIEWPORT_CULLING === 'true';
+// Fraction of the visible size added on each side, so short pans do not pop markers in
+const VIEWPORT_PADDING = 0.25;
+// Breadcrumb trails behind the selected and pinned vehicles
+const TRAILS = import.meta.env.VITE_TRAILS === 'true';
+const TRAIL_MINUTES = parseInt(import.meta.env.VITE_TRAIL_MINUTES || '10', 10);
+// Room for one point per second over the window; faster updates shorten the trail instead
+const TRAIL_CAPACITY = TRAIL_MINUTES * 60;
+// ~1.2 MB of Float32 points across all retained trails
+const TRAIL_POINT_BUDGET = 100_000;
+
 // Fix Leaflet default icon issue
 delete (L.Icon.Default.prototype as any)._getIconUrl;
 L.Icon.Default.mergeOptions({
@@ -14,126 +37,257 @@ L.Icon.Default.mergeOptions({
   shadowUrl: 'https://cdnjs.cloudflare.com/ajax/libs/leaflet/1.7.1/images/marker-shadow.png',
 });
 
-// Create custom vehicle icons based on status
-const createVehicleIcon = (status: VehicleStatus) => {
-  const colors: Record<VehicleStatus, string> = {
-    [VehicleStatus.MOVING]: '#10b981',
-    [VehicleStatus.ONLINE]: '#3b82f6',
-    [VehicleStatus.STOPPED]: '#f59e0b',
-    [VehicleStatus.OFFLINE]: '#6b7280',
-    [VehicleStatus.LOW_BATTERY]: '#ef4444',
-  };
+const FIT_OPTIONS: L.FitBoundsOptions = { padding: [50, 50], maxZoom: 15 };
+// Minimum time between camera moves while following the fleet
+const FOLLOW_FIT_INTERVAL_MS = 2000;
 
-  const color = colors[status] || '#6b7280';
-
-  return L.divIcon({
-    className: 'custom-vehicle-marker',
-    html: `
-      <div style="
-        width: 24px;
-        height: 24px;
-        background-color: ${color};
-        border: 2px solid white;
-        border-radius: 50%;
-        box-shadow: 0 2px 4px rgba(0,0,0,0.3);
-        display: flex;
-        align-items: center;
-        justify-content: center;
-      ">
-        <svg width="12" height="12" viewBox="0 0 20 20" fill="white">
-          <path d="M8 16.5a1.5 1.5 0 11-3 0 1.5 1.5 0 013 0zM15 16.5a1.5 1.5 0 11-3 0 1.5 1.5 0 013 0z" />
-          <path d="M3 4a1 1 0 00-1 1v10a1 1 0 001 1h1.05a2.5 2.5 0 014.9 0H10a1 1 0 001-1V5a1 1 0 00-1-1H3zM14 7a1 1 0 00-1 1v6.05A2.5 2.5 0 0115.95 16H17a1 1 0 001-1v-5a1 1 0 00-.293-.707l-2-2A1 1 0 0015 7h-1z" />
-        </svg>
-      </div>
-    `,
-    iconSize: [24, 24],
-    iconAnchor: [12, 12],
-    popupAnchor: [0, -12],
-  });
+// Fits the map to the filtered fleet on first load, when the user changes a filter,
+// and periodically while following; ordinary updates never move the camera. A
+// warm start keeps the restored view instead of fitting on first load.
+function FleetCamera({ follow }: { follow: boolean }) {
+  const map = useMap();
+  const followRef = useRef(follow);
+  const fitRef = useRef<(() => boolean) | null>(null);
+  followRef.current = follow;
+
+  useEffect(() => {
+    const tracker = new FleetBoundsTracker();
+    const fit = () => {
+      const bounds = tracker.getBounds();
+      if (!bounds) return false;
+      map.fitBounds([[bounds.south, bounds.west], [bounds.north, bounds.east]], FIT_OPTIONS);
+      return true;
+    };
+    fitRef.current = fit;
+
+    // Subscribed first, so the tracker has the delta or filter change by the time we fit
+    const unbind = bindLayerToStore(tracker);
+    let initialFitDone = useFleetStore.getState().hydratedAt !== null || fit();
+    let lastFollowFit = 0;
+
+    const unsubscribeDeltas = subscribeVehicleDeltas(() => {
+      if (!initialFitDone) {
+        initialFitDone = fit();
+      } else if (followRef.current && Date.now() - lastFollowFit >= FOLLOW_FIT_INTERVAL_MS) {
+        lastFollowFit = Date.now();
+        fit();
+      }
+    });
+    let filters = useFleetStore.getState().filters;
+    const unsubscribeFilters = useFleetStore.subscribe((state) => {
+      if (state.filters !== filters && !sameFilterCriteria(state.filters, filters)) {
+        filters = state.filters;
+        fit();
+      }
+    });
+
+    return () => {
+      fitRef.current = null;
+      unbind();
+      unsubscribeDeltas();
+      unsubscribeFilters();
+    };
+  }, [map]);
+
+  // Turning follow on snaps to the fleet immediately
+  useEffect(() => {
+    if (follow) fitRef.current?.();
+  }, [follow]);
+
+  return null;
+}
+
+const paddedBounds = (map: L.Map): GeoBounds => {
+  const bounds = map.getBounds().pad(VIEWPORT_PADDING);
+  return {
+    south: bounds.getSouth(),
+    west: bounds.getWest(),
+    north: bounds.getNorth(),
+    east: bounds.getEast()
+  };
 };
 
-interface VehicleMarkerProps {
-  vehicle: VehicleData;
+// Reports the padded map bounds to the store after every pan/zoom; used for the
+// socket subscription when culling and saved with warm-start snapshots
+function ViewportTracker() {
+  const map = useMap();
+  const setViewport = useFleetStore(state => state.setViewport);
+
+  useEffect(() => {
+    const report = () => {
+      setViewport({ ...paddedBounds(map), zoom: map.getZoom() });
+    };
+    report();
+    map.on('moveend', report);
+    return () => {
+      map.off('moveend', report);
+    };
+  }, [map, setViewport]);
+
+  return null;
 }
 
-const VehicleMarker = memo(({ vehicle }: VehicleMarkerProps) => {
-  const position: [number, number] = [vehicle.latitude, vehicle.longitude];
-  const icon = createVehicleIcon(vehicle.status);
+// Server-provided region aggregates shown in place of vehicles the backend no longer streams
+function ClusterSummaryMarkers() {
+  const map = useMap();
+  const summaries = useFleetStore(state => state.clusterSummaries);
+
+  const zoomTo = (summary: ClusterSummary) => {
+    map.setView([summary.latitude, summary.longitude], map.getZoom() + 2);
+  };
 
   return (
-    <Marker position={position} icon={icon}>
-      <Popup>
-        <div className="p-2 min-w-[200px]">
-          <h3 className="font-bold text-gray-900 mb-2">{vehicle.id}</h3>
-          <div className="space-y-1 text-sm">
-            <div className="flex justify-between">
-              <span className="text-gray-600">Speed:</span>
-              <span className="font-medium">{vehicle.speed.toFixed(1)} km/h</span>
-            </div>
-            <div className="flex justify-between">
-              <span className="text-gray-600">Battery:</span>
-              <span className="font-medium">{vehicle.battery.toFixed(0)}%</span>
-            </div>
-            <div className="flex justify-between">
-              <span className="text-gray-600">Altitude:</span>
-              <span className="font-medium">{vehicle.altitude?.toFixed(0) || 'N/A'} m</span>
-            </div>
-            <div className="flex justify-between">
-              <span className="text-gray-600">Satellites:</span>
-              <span className="font-medium">{vehicle.satellites || 'N/A'}</span>
-            </div>
-            <div className="flex justify-between">
-              <span className="text-gray-600">Status:</span>
-              <span className="font-medium capitalize">{vehicle.status.replace(/_/g, ' ').toLowerCase()}</span>
-            </div>
-          </div>
-        </div>
-      </Popup>
-    </Marker>
+    <>
+      {summaries.map(summary => (
+        <Marker
+          key={summary.id}
+          position={[summary.latitude, summary.longitude]}
+          icon={getClusterIcon(summary.count)}
+          eventHandlers={{ click: () => zoomTo(summary) }}
+        />
+      ))}
+    </>
   );
-}, (prev, next) => {
-  // Only re-render if relevant vehicle data displayed in the popup changed
-  return prev.vehicle.latitude === next.vehicle.latitude &&
-    prev.vehicle.longitude === next.vehicle.longitude &&
-    prev.vehicle.status === next.vehicle.status &&
-    prev.vehicle.speed === next.vehicle.speed &&
-    prev.vehicle.battery === next.vehicle.battery &&
-    prev.vehicle.altitude === next.vehicle.altitude &&
-    prev.vehicle.satellites === next.vehicle.satellites;
-});
+}
+
+// Feeds the WebGL layer from store deltas, rewriting all vertices only when filters change
+function WebGLVehicleMarkers() {
+  const map = useMap();
+
+  useEffect(() => {
+    const layer = new WebGLVehicleLayer();
+    layer.addTo(map);
+    const unbind = bindLayerToStore(layer, { cullToViewport: VIEWPORT_CULLING });
+    // Subscribed after the layer, so the delta has been applied (and its draw requested) here
+    const latency = new LatencySampler();
+    const unsubscribeLatency = subscribeVehicleDeltas((delta) => {
+      latency.sample(delta.changed);
+      latency.commit();
+    });
+
+    return () => {
+      unsubscribeLatency();
+      unbind();
+      layer.remove();
+    };
+  }, [map]);
 
-VehicleMarker.displayName = 'VehicleMarker';
+  return null;
+}
 
-// Component to auto-fit bounds when vehicles change
-function MapUpdater({ vehicles }: { vehicles: VehicleData[] }) {
+// Store deltas feed the cluster worker; each pan/zoom or applied delta re-queries the
+// padded view and the returned features are reconciled onto existing markers
+function ClusteredVehicleMarkers() {
   const map = useMap();
-  const prevVehiclesCountRef = useRef(vehicles.length);
 
   useEffect(() => {
-    if (vehicles.length > 0 && vehicles.length !== prevVehiclesCountRef.current) {
-      const bounds = L.latLngBounds(
-        vehicles.map(v => [v.latitude, v.longitude] as [number, number])
-      );
-      map.fitBounds(bounds, { padding: [50, 50], maxZoom: 15 });
-      prevVehiclesCountRef.current = vehicles.length;
-    }
-  }, [vehicles, map]);
+    const layer = new ClusterMarkerLayer(id => useFleetStore.getState().vehicles.get(id));
+    layer.addTo(map);
+    const index = new ClusterIndexClient();
+    // Deltas reach the screen only once the worker answers the next cluster query
+    const latency = new LatencySampler();
+    const unsubscribeLatency = subscribeVehicleDeltas(delta => latency.sample(delta.changed));
+    index.onClusters((features) => {
+      layer.render(features);
+      latency.commit();
+    });
+
+    const updateView = () => index.setView(paddedBounds(map), map.getZoom());
+    updateView();
+    map.on('moveend', updateView);
+    // The cluster query is already limited to the view, so no viewport culling here
+    const unbind = bindLayerToStore(index);
+
+    return () => {
+      unsubscribeLatency();
+      map.off('moveend', updateView);
+      unbind();
+      index.destroy();
+      layer.remove();
+    };
+  }, [map]);
+
+  return null;
+}
+
+const trackedIds = (selectedVehicleId: string | null, pinned: ReadonlySet<string>): string[] =>
+  selectedVehicleId ? [...pinned, selectedVehicleId] : [...pinned];
+
+// Trails grow from store deltas inside TrailTracker; React state only carries which vehicles are tracked
+function VehicleTrails() {
+  const map = useMap();
+
+  useEffect(() => {
+    const tracker = new TrailTracker({
+      windowMs: TRAIL_MINUTES * 60 * 1000,
+      capacity: TRAIL_CAPACITY,
+      budget: TRAIL_POINT_BUDGET
+    });
+    const layer = new TrailLayer();
+    layer.addTo(map);
+
+    const unsubscribeTrails = tracker.onChange((changed, evicted) => {
+      evicted.forEach(id => layer.drop(id));
+      changed.forEach(id => {
+        if (tracker.isTracked(id)) layer.sync(id, tracker.get(id));
+        else layer.drop(id);
+      });
+    });
+
+    let { selectedVehicleId, pinnedVehicleIds } = useFleetStore.getState();
+    const track = () => {
+      const ids = trackedIds(selectedVehicleId, pinnedVehicleIds);
+      tracker.setTracked(ids);
+      // Start newly tracked trails at the current position instead of the next update
+      const { vehicles } = useFleetStore.getState();
+      tracker.apply(ids.flatMap(id => vehicles.get(id) ?? []));
+    };
+    track();
+
+    const unsubscribeStore = useFleetStore.subscribe((state) => {
+      if (state.selectedVehicleId !== selectedVehicleId || state.pinnedVehicleIds !== pinnedVehicleIds) {
+        selectedVehicleId = state.selectedVehicleId;
+        pinnedVehicleIds = state.pinnedVehicleIds;
+        track();
+      }
+    });
+    const unsubscribeDeltas = subscribeVehicleDeltas((delta) => {
+      if (delta.cleared) tracker.clear();
+      tracker.apply(delta.changed);
+    });
+
+    return () => {
+      unsubscribeTrails();
+      unsubscribeStore();
+      unsubscribeDeltas();
+      layer.remove();
+    };
+  }, [map]);
 
   return null;
 }
 
 function MapView() {
-  const filteredVehicles = useFleetStore(state => state.getFilteredVehicles());
+  // Only the count is selected, so flushes that keep it unchanged do not re-render the map
+  const filteredCount = useFleetStore(state => state.getFilteredVehicles().length);
+  const [followFleet, setFollowFleet] = useState(false);
 
   // Default center (will be updated when vehicles load)
   const defaultCenter: [number, number] = [11.0168, 76.9558]; // Coimbatore, Tamil Nadu
   const defaultZoom = 12;
+  // A warm start reopens the map where the previous session left it
+  const [initialView] = useState(() => {
+    const { viewport, hydratedAt } = useFleetStore.getState();
+    if (!viewport || hydratedAt === null) return { center: defaultCenter, zoom: defaultZoom };
+    const center: [number, number] = [(viewport.south + viewport.north) / 2, (viewport.west + viewport.east) / 2];
+    return { center, zoom: viewport.zoom };
+  });
 
   return (
     <div className="h-full w-full relative" role="region" aria-label="Fleet map view">
       <MapContainer
-        center={defaultCenter}
-        zoom={defaultZoom}
+        center={initialView.center}
+        zoom={initialView.zoom}
         style={{ height: '100%', width: '100%' }}
         zoomControl={true}
       >
@@ -144,29 +298,35 @@ function MapView() {
         />
 
         {/* Marker clustering for performance */}
-        <MarkerClusterGroup
-          chunkedLoading
-          maxClusterRadius={50}
-          spiderfyOnMaxZoom={true}
-          showCoverageOnHover={false}
-          zoomToBoundsOnClick={true}
-        >
-          {filteredVehicles.map(vehicle => (
-            <VehicleMarker key={vehicle.id} vehicle={vehicle} />
-          ))}
-        </MarkerClusterGroup>
+        {MAP_RENDERER === 'webgl' ? <WebGLVehicleMarkers /> : <ClusteredVehicleMarkers />}
+
+        {TRAILS && <VehicleTrails />}
+        <ViewportTracker />
+        <ClusterSummaryMarkers />
 
-        {/* Auto-fit bounds */}
-        <MapUpdater vehicles={filteredVehicles} />
+        {/* Camera fits on explicit triggers only */}
+        <FleetCamera follow={followFleet} />
       </MapContainer>
 
       {/* Map Controls Overlay */}
       <div className="absolute top-4 right-4 z-[1000] flex flex-col gap-2">
         <div className="bg-white rounded-lg shadow-lg px-3 py-2">
           <div className="text-sm font-medium text-gray-700">
-            {filteredVehicles.length} vehicle{filteredVehicles.length !== 1 ? 's' : ''} on map
+            {filteredCount} vehicle{filteredCount !== 1 ? 's' : ''} on map
           </div>
         </div>
+        <button
+          onClick={() => setFollowFleet(!followFleet)}
+          className={`rounded-lg shadow-lg px-3 py-2 text-sm font-medium transition-colors ${
+            followFleet
+              ? 'bg-fleet-primary text-white'
+              : 'bg-white text-gray-700 hover:bg-gray-100'
+          }`}
+          aria-pressed={followFleet}
+          aria-label="Keep the map fitted to the fleet"
+        >
+          Follow fleet
+        </button>
       </div>
     </div>
   );
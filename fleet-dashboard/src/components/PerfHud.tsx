@@ -0,0 +1,108 @@
+import { useEffect, useState } from 'react';
+import { MetricsWindow, PerfCounter, PerfHistogram, onMetricsWindow } from '../utils/perfMetrics';
+
+const TIMING_ROWS: Array<{ label: string; name: PerfHistogram; unit: string }> = [
+  { label: 'Parse', name: PerfHistogram.PARSE, unit: 'ms' },
+  { label: 'Batch size', name: PerfHistogram.BATCH_SIZE, unit: '' },
+  { label: 'Queue to commit', name: PerfHistogram.BATCH_WAIT, unit: 'ms' },
+  { label: 'Flush', name: PerfHistogram.FLUSH, unit: 'ms' },
+  { label: 'Store update', name: PerfHistogram.STORE_UPDATE, unit: 'ms' },
+  { label: 'React commit', name: PerfHistogram.REACT_COMMIT, unit: 'ms' },
+  { label: 'Map update', name: PerfHistogram.MAP_UPDATE, unit: 'ms' },
+  { label: 'Server to screen', name: PerfHistogram.LATENCY, unit: 'ms' }
+];
+
+const formatValue = (value: number, unit: string) =>
+  `${value < 10 ? value.toFixed(2) : Math.round(value).toLocaleString()}${unit}`;
+
+// Toggleable overlay with the last second of ingest and render metrics
+function PerfHud() {
+  const [open, setOpen] = useState(false);
+  const [metrics, setMetrics] = useState<MetricsWindow | null>(null);
+
+  // Sampling only runs while the overlay (or the exporter) listens
+  useEffect(() => {
+    if (!open) return;
+    return onMetricsWindow(setMetrics);
+  }, [open]);
+
+  const seconds = metrics ? Math.max(0.001, (metrics.end - metrics.start) / 1000) : 1;
+  const rate = (name: PerfCounter) => (metrics ? metrics.counters[name] / seconds : 0);
+
+  return (
+    <div className="relative">
+      <button
+        onClick={() => setOpen(!open)}
+        aria-expanded={open}
+        className={`px-3 py-1.5 text-sm font-medium rounded-lg transition-colors ${
+          open ? 'bg-fleet-primary text-white' : 'bg-gray-100 text-gray-700 hover:bg-gray-200'
+        }`}
+      >
+        Perf
+      </button>
+
+      {open && (
+        <div
+          className="absolute right-0 mt-2 z-[1100] w-80 bg-gray-900 text-gray-100 rounded-lg shadow-lg p-3 text-xs font-mono"
+          role="region"
+          aria-label="Performance metrics"
+        >
+          {!metrics ? (
+            <div className="text-gray-400">Collecting…</div>
+          ) : (
+            <table className="w-full tabular-nums">
+              <thead>
+                <tr className="text-gray-400">
+                  <th className="text-left font-normal" />
+                  <th className="text-right font-normal">p50</th>
+                  <th className="text-right font-normal">p99</th>
+                  <th className="text-right font-normal">max</th>
+                </tr>
+              </thead>
+              <tbody>
+                <tr>
+                  <td>Messages/s</td>
+                  <td className="text-right" colSpan={3}>{Math.round(rate(PerfCounter.MESSAGES)).toLocaleString()}</td>
+                </tr>
+                <tr>
+                  <td>KB/s</td>
+                  <td className="text-right" colSpan={3}>{(rate(PerfCounter.BYTES) / 1024).toFixed(1)}</td>
+                </tr>
+                <tr>
+                  <td>Updates/s</td>
+                  <td className="text-right" colSpan={3}>{Math.round(rate(PerfCounter.UPDATES)).toLocaleString()}</td>
+                </tr>
+                <tr>
+                  <td>Deferred/s</td>
+                  <td className="text-right" colSpan={3}>{Math.round(rate(PerfCounter.DEFERRED)).toLocaleString()}</td>
+                </tr>
+                {TIMING_ROWS.map(({ label, name, unit }) => {
+                  const histogram = metrics.histograms[name];
+                  if (histogram.count === 0) {
+                    return (
+                      <tr key={name} className="text-gray-500">
+                        <td>{label}</td>
+                        <td className="text-right" colSpan={3}>–</td>
+                      </tr>
+                    );
+                  }
+                  const summary = histogram.summary();
+                  return (
+                    <tr key={name}>
+                      <td>{label}</td>
+                      <td className="text-right">{formatValue(summary.p50, unit)}</td>
+                      <td className="text-right">{formatValue(summary.p99, unit)}</td>
+                      <td className="text-right">{formatValue(summary.max, unit)}</td>
+                    </tr>
+                  );
+                })}
+              </tbody>
+            </table>
+          )}
+        </div>
+      )}
+    </div>
+  );
+}
+
+export default PerfHud;
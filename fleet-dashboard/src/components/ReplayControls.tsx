@@ -0,0 +1,157 @@
+import { useEffect, useRef, useState } from 'react';
+import { format } from 'date-fns';
+import { useFleetStore } from '../stores/fleetStore';
+import { RestApiClient } from '../api/restClient';
+import { loadFleetHistory } from '../api/replayLoader';
+import { ReplayPlayer } from '../utils/replayPlayer';
+import { ReplayTimeline } from '../utils/replayTimeline';
+import { timeRangeWindow } from '../utils/timeRange';
+
+const SPEED_OPTIONS = [1, 10, 25, 50, 100];
+
+type ReplayPhase = 'idle' | 'loading' | 'ready';
+
+interface ReplayControlsProps {
+  client: RestApiClient;
+}
+
+// Replays the filter's time range through the store; live updates pause until exit
+function ReplayControls({ client }: ReplayControlsProps) {
+  const timeRange = useFleetStore(state => state.filters.timeRange);
+  const [phase, setPhase] = useState<ReplayPhase>('idle');
+  const [progress, setProgress] = useState({ loaded: 0, total: 0 });
+  const [timeline, setTimeline] = useState<ReplayTimeline | null>(null);
+  const [time, setTime] = useState(0);
+  const [playing, setPlaying] = useState(false);
+  const [speed, setSpeed] = useState(SPEED_OPTIONS[1]);
+  const playerRef = useRef<ReplayPlayer | null>(null);
+  const abortRef = useRef<AbortController | null>(null);
+
+  const start = async () => {
+    const { vehicles } = useFleetStore.getState();
+    const controller = new AbortController();
+    abortRef.current = controller;
+    setPhase('loading');
+
+    try {
+      const vehicleIds = vehicles.size > 0
+        ? Array.from(vehicles.keys())
+        : (await client.getVehicles({ signal: controller.signal })).map(vehicle => vehicle.id);
+      setProgress({ loaded: 0, total: vehicleIds.length });
+      const loaded = await loadFleetHistory(client, vehicleIds, timeRangeWindow(timeRange), {
+        signal: controller.signal,
+        onProgress: (count, total) => setProgress({ loaded: count, total })
+      });
+
+      const { clearVehicles, updateVehicles, setReplayActive } = useFleetStore.getState();
+      setReplayActive(true);
+      clearVehicles();
+      const player = new ReplayPlayer(loaded, updateVehicles);
+      player.setSpeed(speed);
+      player.onTick((current, isPlaying) => {
+        setTime(current);
+        setPlaying(isPlaying);
+      });
+      playerRef.current = player;
+      setTimeline(loaded);
+      setPhase('ready');
+      player.seek(loaded.start);
+    } catch (error) {
+      if (!controller.signal.aborted) console.error('Failed to load replay:', error);
+      setPhase('idle');
+    } finally {
+      abortRef.current = null;
+    }
+  };
+
+  // Drops replayed state and reseeds the store from the REST snapshot; the socket,
+  // which kept running, fills in from there
+  const exit = () => {
+    abortRef.current?.abort();
+    playerRef.current?.destroy();
+    playerRef.current = null;
+    setTimeline(null);
+    setPhase('idle');
+
+    const { replayActive, clearVehicles, setReplayActive, updateVehicles } = useFleetStore.getState();
+    if (!replayActive) return;
+    clearVehicles();
+    setReplayActive(false);
+    client.getVehicles({ force: true })
+      .then(vehicles => updateVehicles(new Map(vehicles.map(vehicle => [vehicle.id, vehicle]))))
+      .catch(error => console.error('Failed to reload live vehicles:', error));
+  };
+
+  useEffect(() => () => {
+    abortRef.current?.abort();
+    playerRef.current?.destroy();
+  }, []);
+
+  const changeSpeed = (next: number) => {
+    setSpeed(next);
+    playerRef.current?.setSpeed(next);
+  };
+
+  if (phase === 'idle') {
+    return (
+      <button
+        onClick={start}
+        className="px-3 py-1.5 text-sm font-medium rounded-lg bg-gray-100 text-gray-700 hover:bg-gray-200 transition-colors"
+        aria-label="Replay fleet history for the selected time range"
+      >
+        Replay
+      </button>
+    );
+  }
+
+  if (phase === 'loading' || !timeline) {
+    return (
+      <div className="flex items-center gap-3 text-sm text-gray-600" role="status">
+        <span>
+          Loading history {progress.loaded.toLocaleString()}/{progress.total.toLocaleString()}
+        </span>
+        <button onClick={exit} className="text-gray-500 hover:text-gray-700">
+          Cancel
+        </button>
+      </div>
+    );
+  }
+
+  return (
+    <div className="flex items-center gap-3 text-sm" role="group" aria-label="Replay controls">
+      <button
+        onClick={() => (playing ? playerRef.current?.pause() : playerRef.current?.play())}
+        className="px-3 py-1.5 font-medium rounded-lg bg-fleet-primary text-white"
+        aria-label={playing ? 'Pause replay' : 'Play replay'}
+      >
+        {playing ? 'Pause' : 'Play'}
+      </button>
+      <input
+        type="range"
+        min={timeline.start}
+        max={timeline.end}
+        step={1000}
+        value={time}
+        onChange={(e) => playerRef.current?.seek(Number(e.target.value))}
+        className="w-64"
+        aria-label="Replay position"
+      />
+      <span className="w-32 text-gray-700 tabular-nums">{format(time, 'MMM d HH:mm:ss')}</span>
+      <select
+        value={speed}
+        onChange={(e) => changeSpeed(Number(e.target.value))}
+        className="px-2 py-1 border border-gray-300 rounded-lg focus:ring-2 focus:ring-fleet-primary focus:border-fleet-primary"
+        aria-label="Replay speed"
+      >
+        {SPEED_OPTIONS.map(option => (
+          <option key={option} value={option}>{option}x</option>
+        ))}
+      </select>
+      <button onClick={exit} className="text-gray-500 hover:text-gray-700">
+        Exit replay
+      </button>
+    </div>
+  );
+}
+
+export default ReplayControls;
@@ -0,0 +1,182 @@
+import { useEffect, useMemo, useState } from 'react';
+import {
+  Chart as ChartJS,
+  LineElement,
+  PointElement,
+  LinearScale,
+  Tooltip,
+  Legend,
+  ChartData,
+  ChartOptions
+} from 'chart.js';
+import { Line } from 'react-chartjs-2';
+import { format } from 'date-fns';
+import { useFleetStore } from '../stores/fleetStore';
+import { RestApiClient } from '../api/restClient';
+import { TelemetrySeries } from '../utils/telemetrySeries';
+import { lttb, minMax } from '../utils/downsample';
+import { timeRangeWindow } from '../utils/timeRange';
+import { useElementSize } from '../hooks/useElementSize';
+
+ChartJS.register(LineElement, PointElement, LinearScale, Tooltip, Legend);
+
+// Trails are drawn by the map; pinning keeps one visible after the selection moves on
+const TRAILS = import.meta.env.VITE_TRAILS === 'true';
+
+// Redraw at most this often while a long history is still streaming in
+const PROGRESS_RENDER_MS = 250;
+
+type Point = { x: number; y: number };
+
+const toPoints = (series: TelemetrySeries, column: Float32Array, indices: Uint32Array): Point[] =>
+  Array.from(indices, i => ({ x: series.timestamp[i], y: column[i] }));
+
+const CHART_OPTIONS: ChartOptions<'line'> = {
+  animation: false,
+  parsing: false,
+  normalized: true,
+  maintainAspectRatio: false,
+  elements: { point: { radius: 0 }, line: { borderWidth: 1.5 } },
+  interaction: { mode: 'nearest', axis: 'x', intersect: false },
+  scales: {
+    x: {
+      type: 'linear',
+      ticks: { maxTicksLimit: 8, callback: (value) => format(Number(value), 'MMM d HH:mm') }
+    },
+    speed: { type: 'linear', position: 'left', title: { display: true, text: 'km/h' } },
+    battery: { type: 'linear', position: 'right', min: 0, max: 100, grid: { drawOnChartArea: false } }
+  },
+  plugins: {
+    tooltip: { callbacks: { title: (items) => format(Number(items[0].parsed.x), 'MMM d HH:mm:ss') } }
+  }
+};
+
+interface VehicleHistoryChartProps {
+  client: RestApiClient;
+}
+
+// Speed and battery history of the selected vehicle, streamed and reduced to the plot width
+function VehicleHistoryChart({ client }: VehicleHistoryChartProps) {
+  const vehicleId = useFleetStore(state => state.selectedVehicleId);
+  const timeRange = useFleetStore(state => state.filters.timeRange);
+  const selectVehicle = useFleetStore(state => state.selectVehicle);
+  const pinned = useFleetStore(state => vehicleId !== null && state.pinnedVehicleIds.has(vehicleId));
+  const togglePinnedVehicle = useFleetStore(state => state.togglePinnedVehicle);
+  const [containerRef, { width }] = useElementSize<HTMLDivElement>();
+  const [series, setSeries] = useState<TelemetrySeries | null>(null);
+  // The series fills in place while streaming; the revision tells memos to re-read it
+  const [revision, setRevision] = useState(0);
+  const [loading, setLoading] = useState(false);
+  const [error, setError] = useState<string | null>(null);
+
+  useEffect(() => {
+    if (!vehicleId) return;
+
+    const controller = new AbortController();
+    const { start, end } = timeRangeWindow(timeRange);
+    let lastRender = 0;
+    const show = (next: TelemetrySeries) => {
+      setSeries(next);
+      setRevision(r => r + 1);
+    };
+
+    setSeries(null);
+    setError(null);
+    setLoading(true);
+
+    client.streamHistoricalData(
+      {
+        vehicleId,
+        start: new Date(start).toISOString(),
+        end: new Date(end).toISOString()
+      },
+      {
+        signal: controller.signal,
+        onProgress: (partial) => {
+          const now = performance.now();
+          if (now - lastRender >= PROGRESS_RENDER_MS) {
+            lastRender = now;
+            show(partial);
+          }
+        }
+      }
+    )
+      .then(show)
+      .catch((err: Error) => {
+        if (!controller.signal.aborted) setError(err.message);
+      })
+      .finally(() => {
+        if (!controller.signal.aborted) setLoading(false);
+      });
+
+    return () => controller.abort();
+  }, [client, vehicleId, timeRange]);
+
+  const data = useMemo<ChartData<'line', Point[]> | null>(() => {
+    if (!series || series.length === 0 || width === 0) return null;
+    // One point per horizontal pixel is all the canvas can show
+    const pixels = Math.max(4, Math.floor(width));
+    const { timestamp, speed, battery, length } = series;
+    return {
+      datasets: [
+        {
+          label: 'Speed (km/h)',
+          // LTTB keeps the shape of a noisy signal
+          data: toPoints(series, speed, lttb(timestamp, speed, length, pixels)),
+          yAxisID: 'speed',
+          borderColor: '#3b82f6'
+        },
+        {
+          label: 'Battery (%)',
+          // Min-max keeps short drops visible, two points per bucket
+          data: toPoints(series, battery, minMax(timestamp, battery, length, pixels >> 1)),
+          yAxisID: 'battery',
+          borderColor: '#10b981'
+        }
+      ]
+    };
+    // revision is only a change signal: the series is filled in place while it streams
+  }, [series, revision, width]);
+
+  if (!vehicleId) return null;
+
+  return (
+    <section className="h-64 bg-white border-t border-gray-200 flex flex-col" aria-label={`History for ${vehicleId}`}>
+      <div className="flex items-center justify-between px-4 py-2 border-b border-gray-200">
+        <h2 className="text-sm font-semibold text-gray-900">
+          {vehicleId} history
+          {series && <span className="ml-2 font-normal text-gray-500">{series.length.toLocaleString()} points</span>}
+          {loading && <span className="ml-2 font-normal text-gray-500">loading…</span>}
+        </h2>
+        <div className="flex items-center gap-3">
+          {TRAILS && (
+            <button
+              onClick={() => togglePinnedVehicle(vehicleId)}
+              className={`text-sm ${pinned ? 'text-fleet-primary font-medium' : 'text-gray-500 hover:text-gray-700'}`}
+              aria-pressed={pinned}
+              aria-label={`Keep the trail of ${vehicleId} on the map`}
+            >
+              Pin trail
+            </button>
+          )}
+          <button
+            onClick={() => selectVehicle(null)}
+            className="text-sm text-gray-500 hover:text-gray-700"
+            aria-label="Close history chart"
+          >
+            ✕
+          </button>
+        </div>
+      </div>
+      <div ref={containerRef} className="flex-1 min-h-0 px-2 py-1">
+        {error ? (
+          <p className="text-sm text-red-600 p-2">Failed to load history: {error}</p>
+        ) : data ? (
+          <Line data={data} options={CHART_OPTIONS} />
+        ) : null}
+      </div>
+    </section>
+  );
+}
+
+export default VehicleHistoryChart;
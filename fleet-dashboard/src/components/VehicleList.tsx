@@ -1,16 +1,36 @@
-import { memo } from 'react';
-import { FixedSizeList as List } from 'react-window';
-import { useFleetStore } from '../stores/fleetStore';
-import { VehicleData, VehicleStatus } from '../types';
+import { memo, useMemo } from 'react';
+import { FixedSizeList as List, ListChildComponentProps, areEqual } from 'react-window';
+import { useFleetStore, isUnconfirmed } from '../stores/fleetStore';
+import { VehicleData, VehicleStatus, SortField } from '../types';
 import { formatDistanceToNow } from 'date-fns';
+import { useNow } from '../hooks/useNow';
+import { useElementSize } from '../hooks/useElementSize';
+
+const ROW_HEIGHT = 100;
+
+// Re-renders on the shared one-second tick, independently of data flushes
+const RelativeTime = memo(({ timestamp }: { timestamp: number }) => {
+  const now = useNow();
+  const label = useMemo(
+    () => formatDistanceToNow(Math.min(timestamp, now), { addSuffix: true }),
+    [timestamp, now]
+  );
+  return <>{label}</>;
+});
+
+RelativeTime.displayName = 'RelativeTime';
 
 interface VehicleItemProps {
   vehicle: VehicleData;
+  // Write version of the vehicle; columnar store views keep their identity across updates
+  version: number;
+  // Restored from the warm-start snapshot and not yet seen on the live stream
+  stale: boolean;
   isSelected: boolean;
-  onClick: () => void;
+  onSelect: (vehicleId: string) => void;
 }
 
-const VehicleItem = memo(({ vehicle, isSelected, onClick }: VehicleItemProps) => {
+const VehicleItem = memo(({ vehicle, stale, isSelected, onSelect }: VehicleItemProps) => {
   const getStatusColor = (status: VehicleStatus) => {
     switch (status) {
       case VehicleStatus.MOVING:
@@ -36,11 +56,12 @@ const VehicleItem = memo(({ vehicle, isSelected, onClick }: VehicleItemProps) =>
 
   return (
     <button
-      onClick={onClick}
+      onClick={() => onSelect(vehicle.id)}
+      aria-pressed={isSelected}
       className={`w-full text-left px-4 py-3 border-b border-gray-200 hover:bg-gray-50 transition-colors ${
         isSelected ? 'bg-blue-50 border-l-4 border-l-fleet-primary' : ''
-      }`}
-      aria-label={`Vehicle ${vehicle.id}, speed ${vehicle.speed} km/h, battery ${vehicle.battery}%`}
+      } ${stale ? 'opacity-60' : ''}`}
+      aria-label={`Vehicle ${vehicle.id}, speed ${vehicle.speed} km/h, battery ${vehicle.battery}%${stale ? ', cached' : ''}`}
     >
       <div className="flex items-start justify-between">
         <div className="flex-1 min-w-0">
@@ -73,8 +94,9 @@ const VehicleItem = memo(({ vehicle, isSelected, onClick }: VehicleItemProps) =>
         </div>
 
         {/* Last Update */}
-        <div className="text-xs text-gray-500 ml-2">
-          {formatDistanceToNow(vehicle.lastUpdate, { addSuffix: true })}
+        <div className="text-xs text-gray-500 ml-2 text-right">
+          <RelativeTime timestamp={vehicle.lastUpdate} />
+          {stale && <div className="italic">cached</div>}
         </div>
       </div>
     </button>
@@ -83,21 +105,56 @@ const VehicleItem = memo(({ vehicle, isSelected, onClick }: VehicleItemProps) =>
 
 VehicleItem.displayName = 'VehicleItem';
 
+interface RowData {
+  vehicleAt: (index: number) => VehicleData | undefined;
+  selectedVehicleId: string | null;
+  onSelect: (vehicleId: string) => void;
+}
+
+const versionOf = (vehicleId: string) => useFleetStore.getState().vehicles.versionOf(vehicleId);
+
+// Module-level so react-window keeps the same row type across flushes; only rows
+// whose vehicle or selection changed re-render
+const VehicleRow = memo(({ index, style, data }: ListChildComponentProps<RowData>) => {
+  const vehicle = data.vehicleAt(index);
+  if (!vehicle) return <div style={style} />;
+  return (
+    <div style={style}>
+      <VehicleItem
+        vehicle={vehicle}
+        version={versionOf(vehicle.id)}
+        stale={isUnconfirmed(vehicle)}
+        isSelected={vehicle.id === data.selectedVehicleId}
+        onSelect={data.onSelect}
+      />
+    </div>
+  );
+}, areEqual);
+
+VehicleRow.displayName = 'VehicleRow';
+
 function VehicleList() {
   const filteredVehicles = useFleetStore(state => state.getFilteredVehicles());
-  
-  const Row = ({ index, style }: { index: number; style: React.CSSProperties }) => {
-    const vehicle = filteredVehicles[index];
-    return (
-      <div style={style}>
-        <VehicleItem
-          vehicle={vehicle}
-          isSelected={false}
-          onClick={() => console.log('Selected vehicle:', vehicle.id)}
-        />
-      </div>
-    );
-  };
+  const sorted = useFleetStore(state => state.filters.sortBy !== SortField.NONE);
+  // Sorted rows are read by position from the store's ordered index, which changes in
+  // place; the version (and sort settings) tell the list when to re-read the window
+  const sortVersion = useFleetStore(state =>
+    sorted ? `${state.vehiclesVersion}:${state.filters.sortBy}:${state.filters.sortDirection}` : ''
+  );
+  const getVehicleAt = useFleetStore(state => state.getVehicleAt);
+  const selectedVehicleId = useFleetStore(state => state.selectedVehicleId);
+  const selectVehicle = useFleetStore(state => state.selectVehicle);
+  const [containerRef, { height }] = useElementSize<HTMLDivElement>();
+
+  const itemData = useMemo<RowData>(
+    () => ({
+      vehicleAt: sorted ? getVehicleAt : (index: number) => filteredVehicles[index],
+      selectedVehicleId,
+      onSelect: selectVehicle
+    }),
+    // sortVersion is only a change signal for the sorted accessor
+    [sorted, sortVersion, getVehicleAt, filteredVehicles, selectedVehicleId, selectVehicle]
+  );
 
   if (filteredVehicles.length === 0) {
     return (
@@ -112,18 +169,24 @@ function VehicleList() {
   }
 
   return (
-    <div className="h-full" role="list" aria-label="Vehicle list">
+    <div className="h-full flex flex-col" role="list" aria-label="Vehicle list">
       <div className="px-4 py-2 bg-gray-50 border-b border-gray-200 text-sm text-gray-600">
         {filteredVehicles.length} vehicle{filteredVehicles.length !== 1 ? 's' : ''}
       </div>
-      <List
-        height={600}
-        itemCount={filteredVehicles.length}
-        itemSize={100}
-        width="100%"
-      >
-        {Row}
-      </List>
+      <div ref={containerRef} className="flex-1 min-h-0">
+        {height > 0 && (
+          <List
+            height={height}
+            itemCount={filteredVehicles.length}
+            itemSize={ROW_HEIGHT}
+            itemData={itemData}
+            itemKey={(index, data) => data.vehicleAt(index)?.id ?? index}
+            width="100%"
+          >
+            {VehicleRow}
+          </List>
+        )}
+      </div>
     </div>
   );
 }
@@ -0,0 +1,127 @@
+import { VehicleData, GeoBounds } from '../../types';
+import { ClusterIndex, ClusterFeature } from '../../utils/clusterIndex';
+import { encodeStatus, STATUS_ABSENT } from '../../utils/telemetryCodec';
+import { ClusterPointBatch, ClusterWorkerCommand, ClusterWorkerEvent } from '../../workers/protocol';
+import { VehicleLayerSink } from './bindLayerToStore';
+
+export type ClusterFeaturesHandler = (features: ClusterFeature[]) => void;
+
+/**
+ * Layer sink that feeds store deltas into the cluster worker and re-queries
+ * the current view at most once per frame. Filtered-out vehicles are removed
+ * from the index, so clusters only count what the filters let through. Runs
+ * the index inline when workers are unavailable.
+ */
+export class ClusterIndexClient implements VehicleLayerSink {
+  private worker: Worker | null = null;
+  private localIndex: ClusterIndex | null = null;
+  private handlers: Set<ClusterFeaturesHandler> = new Set();
+  private view: { bounds: GeoBounds; zoom: number } | null = null;
+  private requestId: number = 0;
+  private appliedRequestId: number = 0;
+  private queryScheduled: boolean = false;
+
+  constructor() {
+    if (typeof Worker !== 'undefined') {
+      this.worker = new Worker(new URL('../../workers/cluster.worker.ts', import.meta.url), {
+        type: 'module'
+      });
+      this.worker.onmessage = (event: MessageEvent<ClusterWorkerEvent>) => {
+        const message = event.data;
+        // Responses arrive in request order; anything older than the last applied one is stale
+        if (message.requestId > this.appliedRequestId) {
+          this.appliedRequestId = message.requestId;
+          this.emit(message.features);
+        }
+      };
+    } else {
+      this.localIndex = new ClusterIndex();
+    }
+  }
+
+  public onClusters(handler: ClusterFeaturesHandler): () => void {
+    this.handlers.add(handler);
+    return () => this.handlers.delete(handler);
+  }
+
+  public apply(vehicles: Iterable<VehicleData>, isVisible: (vehicle: VehicleData) => boolean): void {
+    const list = Array.isArray(vehicles) ? vehicles : Array.from(vehicles);
+    if (list.length === 0) return;
+
+    const points: ClusterPointBatch = {
+      ids: new Array(list.length),
+      latitude: new Float64Array(list.length),
+      longitude: new Float64Array(list.length),
+      status: new Uint8Array(list.length)
+    };
+    list.forEach((vehicle, i) => {
+      points.ids[i] = vehicle.id;
+      points.latitude[i] = vehicle.latitude;
+      points.longitude[i] = vehicle.longitude;
+      points.status[i] = isVisible(vehicle) ? encodeStatus(vehicle.status) : STATUS_ABSENT;
+    });
+
+    if (this.localIndex) {
+      for (let i = 0; i < list.length; i++) {
+        if (points.status[i] === STATUS_ABSENT) {
+          this.localIndex.remove(points.ids[i]);
+        } else {
+          this.localIndex.upsert(points.ids[i], points.latitude[i], points.longitude[i], points.status[i]);
+        }
+      }
+    } else {
+      this.send({ type: 'update', points }, [points.latitude.buffer, points.longitude.buffer, points.status.buffer]);
+    }
+    this.scheduleQuery();
+  }
+
+  public clear(): void {
+    this.localIndex?.clear();
+    this.send({ type: 'clear' });
+    this.scheduleQuery();
+  }
+
+  public setView(bounds: GeoBounds, zoom: number): void {
+    this.view = { bounds, zoom };
+    this.query();
+  }
+
+  public destroy(): void {
+    this.worker?.terminate();
+    this.worker = null;
+    this.handlers.clear();
+  }
+
+  // Bursts of deltas within one frame share a single query
+  private scheduleQuery(): void {
+    if (this.queryScheduled || !this.view) return;
+    this.queryScheduled = true;
+    const run = () => {
+      this.queryScheduled = false;
+      this.query();
+    };
+    if (typeof requestAnimationFrame === 'function') {
+      requestAnimationFrame(run);
+    } else {
+      setTimeout(run, 16);
+    }
+  }
+
+  private query(): void {
+    if (!this.view) return;
+    const { bounds, zoom } = this.view;
+    if (this.localIndex) {
+      this.emit(this.localIndex.query(bounds, zoom));
+    } else {
+      this.send({ type: 'query', requestId: ++this.requestId, bounds, zoom });
+    }
+  }
+
+  private emit(features: ClusterFeature[]): void {
+    this.handlers.forEach(handler => handler(features));
+  }
+
+  private send(command: ClusterWorkerCommand, transfer: Transferable[] = []): void {
+    this.worker?.postMessage(command, transfer);
+  }
+}
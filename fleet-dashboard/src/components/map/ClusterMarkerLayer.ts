@@ -0,0 +1,107 @@
+import L from 'leaflet';
+import { VehicleData } from '../../types';
+import { ClusterFeature } from '../../utils/clusterIndex';
+import { getVehicleIcon, getClusterIcon } from './vehicleIcons';
+import { vehiclePopupHtml } from './vehicleStyle';
+import { PerfHistogram, perfMeasure, perfStart } from '../../utils/perfMetrics';
+
+// Zoom levels to step in when a cluster is clicked
+const CLUSTER_CLICK_ZOOM_STEP = 2;
+
+/**
+ * Draws the features returned by a cluster query. Markers are reconciled by
+ * feature ID: one that is still present is moved and restyled in place, and
+ * only features that appeared or disappeared add or remove a marker. Single
+ * vehicles are keyed by vehicle ID, so their marker (and open popup) survive
+ * zoom changes.
+ */
+export class ClusterMarkerLayer extends L.LayerGroup {
+  private markers: Map<string, L.Marker> = new Map();
+  private features: Map<string, ClusterFeature> = new Map();
+  private lookup: (id: string) => VehicleData | undefined;
+  private map: L.Map | null = null;
+
+  constructor(lookup: (id: string) => VehicleData | undefined) {
+    super();
+    this.lookup = lookup;
+  }
+
+  public onAdd(map: L.Map): this {
+    this.map = map;
+    return super.onAdd(map);
+  }
+
+  public onRemove(map: L.Map): this {
+    this.map = null;
+    return super.onRemove(map);
+  }
+
+  public render(features: ClusterFeature[]): void {
+    const start = perfStart();
+    const next: Map<string, ClusterFeature> = new Map();
+    features.forEach(feature => next.set(feature.id, feature));
+
+    this.markers.forEach((marker, id) => {
+      if (!next.has(id)) {
+        this.removeLayer(marker);
+        this.markers.delete(id);
+      }
+    });
+
+    next.forEach((feature, id) => {
+      const previous = this.features.get(id);
+      const marker = this.markers.get(id);
+
+      if (!marker || !previous) {
+        this.addMarker(feature);
+        return;
+      }
+      if (previous.latitude !== feature.latitude || previous.longitude !== feature.longitude) {
+        marker.setLatLng([feature.latitude, feature.longitude]);
+      }
+      if (previous.count !== feature.count || previous.status !== feature.status) {
+        marker.setIcon(this.iconFor(feature));
+      }
+      if (feature.vehicleId && marker.isPopupOpen()) {
+        const vehicle = this.lookup(feature.vehicleId);
+        if (vehicle) marker.setPopupContent(vehiclePopupHtml(vehicle));
+      }
+    });
+
+    this.features = next;
+    perfMeasure(PerfHistogram.MAP_UPDATE, start);
+  }
+
+  public clearMarkers(): void {
+    this.clearLayers();
+    this.markers.clear();
+    this.features.clear();
+  }
+
+  private addMarker(feature: ClusterFeature): void {
+    const marker = L.marker([feature.latitude, feature.longitude], { icon: this.iconFor(feature) });
+    const vehicleId = feature.vehicleId;
+
+    if (vehicleId) {
+      // Popup HTML is built lazily from the latest store data when it opens
+      marker.bindPopup(() => {
+        const vehicle = this.lookup(vehicleId);
+        return vehicle ? vehiclePopupHtml(vehicle) : '';
+      });
+    } else {
+      marker.on('click', () => {
+        const current = this.features.get(feature.id) ?? feature;
+        this.map?.setView([current.latitude, current.longitude], this.map.getZoom() + CLUSTER_CLICK_ZOOM_STEP);
+      });
+    }
+
+    this.markers.set(feature.id, marker);
+    this.addLayer(marker);
+  }
+
+  private iconFor(feature: ClusterFeature): L.DivIcon {
+    return feature.vehicleId && feature.status
+      ? getVehicleIcon(feature.status)
+      : getClusterIcon(feature.count);
+  }
+}
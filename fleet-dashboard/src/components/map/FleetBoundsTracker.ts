@@ -0,0 +1,85 @@
+import { VehicleData, GeoBounds } from '../../types';
+import { VehicleLayerSink } from './bindLayerToStore';
+
+type Extreme = 'south' | 'west' | 'north' | 'east';
+
+/**
+ * Running bounding box of the vehicles that pass the filters. Deltas only
+ * widen the box, or mark it dirty when the vehicle holding one of its edges
+ * moves inward or drops out. A full recompute then happens on the next read,
+ * which only the explicit camera fits trigger.
+ */
+export class FleetBoundsTracker implements VehicleLayerSink {
+  private visible: Map<string, VehicleData> = new Map();
+  private bounds: GeoBounds | null = null;
+  private holders: Record<Extreme, string | null> = { south: null, west: null, north: null, east: null };
+  private dirty: boolean = false;
+
+  public get size(): number {
+    return this.visible.size;
+  }
+
+  public apply(vehicles: Iterable<VehicleData>, isVisible: (vehicle: VehicleData) => boolean): void {
+    for (const vehicle of vehicles) {
+      if (isVisible(vehicle)) {
+        this.visible.set(vehicle.id, vehicle);
+        if (!this.dirty) this.include(vehicle);
+      } else if (this.visible.delete(vehicle.id) && this.holds(vehicle.id)) {
+        this.dirty = true;
+      }
+    }
+  }
+
+  public clear(): void {
+    this.visible.clear();
+    this.bounds = null;
+    this.holders = { south: null, west: null, north: null, east: null };
+    this.dirty = false;
+  }
+
+  public getBounds(): GeoBounds | null {
+    if (this.dirty) this.recompute();
+    return this.bounds;
+  }
+
+  private include(vehicle: VehicleData): void {
+    const { id, latitude, longitude } = vehicle;
+    if (!this.bounds) {
+      this.bounds = { south: latitude, west: longitude, north: latitude, east: longitude };
+      this.holders = { south: id, west: id, north: id, east: id };
+      return;
+    }
+
+    // A holder that moved inward may no longer be the extreme
+    if (
+      (this.holders.south === id && latitude > this.bounds.south) ||
+      (this.holders.north === id && latitude < this.bounds.north) ||
+      (this.holders.west === id && longitude > this.bounds.west) ||
+      (this.holders.east === id && longitude < this.bounds.east)
+    ) {
+      this.dirty = true;
+      return;
+    }
+
+    if (latitude <= this.bounds.south) this.setEdge('south', latitude, id);
+    if (latitude >= this.bounds.north) this.setEdge('north', latitude, id);
+    if (longitude <= this.bounds.west) this.setEdge('west', longitude, id);
+    if (longitude >= this.bounds.east) this.setEdge('east', longitude, id);
+  }
+
+  private setEdge(edge: Extreme, value: number, id: string): void {
+    this.bounds![edge] = value;
+    this.holders[edge] = id;
+  }
+
+  private holds(id: string): boolean {
+    return this.holders.south === id || this.holders.west === id ||
+      this.holders.north === id || this.holders.east === id;
+  }
+
+  private recompute(): void {
+    this.bounds = null;
+    this.dirty = false;
+    this.visible.forEach(vehicle => this.include(vehicle));
+  }
+}
@@ -0,0 +1,70 @@
+import L from 'leaflet';
+import { TrailBuffer } from '../../utils/trailBuffer';
+
+// Points per polyline; appending redraws only the last chunk of a trail
+const CHUNK_POINTS = 64;
+
+const TRAIL_STYLE: L.PolylineOptions = { color: '#2563eb', weight: 3, opacity: 0.8, interactive: false };
+
+interface Chunk {
+  line: L.Polyline;
+  points: number;
+  lastSeq: number;
+}
+
+interface DrawnTrail {
+  chunks: Chunk[];
+  // Sequence number of the next trail point to draw
+  drawnSeq: number;
+  last: L.LatLngTuple | null;
+}
+
+/**
+ * Draws TrailBuffers as chains of short polylines. New points are appended to
+ * the tail chunk; chunks whose points have all been pruned from the buffer are
+ * removed from the head. Older chunks are never rebuilt; a dropped trail is
+ * redrawn from its buffer the next time it is synced.
+ */
+export class TrailLayer extends L.LayerGroup {
+  private drawn: Map<string, DrawnTrail> = new Map();
+
+  public sync(vehicleId: string, trail: TrailBuffer | undefined): void {
+    if (!trail) {
+      this.drop(vehicleId);
+      return;
+    }
+    let drawn = this.drawn.get(vehicleId);
+    if (!drawn) {
+      drawn = { chunks: [], drawnSeq: 0, last: null };
+      this.drawn.set(vehicleId, drawn);
+    }
+
+    while (drawn.chunks.length > 0 && drawn.chunks[0].lastSeq < trail.firstSeq) {
+      this.removeLayer(drawn.chunks.shift()!.line);
+    }
+    if (drawn.chunks.length === 0) drawn.last = null;
+
+    const target = drawn;
+    trail.forEachSince(drawn.drawnSeq, (latitude, longitude, seq) => {
+      let tail = target.chunks[target.chunks.length - 1];
+      if (!tail || tail.points >= CHUNK_POINTS) {
+        // Each chunk starts at the previous chunk's last point so the chain stays joined
+        tail = { line: L.polyline(target.last ? [target.last] : [], TRAIL_STYLE), points: 0, lastSeq: seq };
+        target.chunks.push(tail);
+        this.addLayer(tail.line);
+      }
+      target.last = [latitude, longitude];
+      tail.line.addLatLng(target.last);
+      tail.points++;
+      tail.lastSeq = seq;
+    });
+    drawn.drawnSeq = trail.nextSeq;
+  }
+
+  public drop(vehicleId: string): void {
+    const drawn = this.drawn.get(vehicleId);
+    if (!drawn) return;
+    drawn.chunks.forEach(chunk => this.removeLayer(chunk.line));
+    this.drawn.delete(vehicleId);
+  }
+}
@@ -0,0 +1,109 @@
+import { VehicleData } from '../../types';
+import { TrailBuffer } from '../../utils/trailBuffer';
+
+export interface TrailTrackerOptions {
+  // Length of trail kept behind each vehicle
+  windowMs: number;
+  // Points per trail ring
+  capacity: number;
+  // Total points across all rings; trails of untracked vehicles are evicted LRU beyond it
+  budget: number;
+}
+
+export type TrailChangeHandler = (changed: string[], evicted: string[]) => void;
+
+/**
+ * Breadcrumb trails of the tracked vehicles, appended from store deltas into
+ * per-vehicle TrailBuffers outside React state. A vehicle that stops being
+ * tracked keeps its trail (so re-selecting it is instant) until the point
+ * budget needs the room; Map insertion order serves as the LRU list.
+ */
+export class TrailTracker {
+  private options: TrailTrackerOptions;
+  private trails: Map<string, TrailBuffer> = new Map();
+  private tracked: Set<string> = new Set();
+  private handlers: Set<TrailChangeHandler> = new Set();
+
+  constructor(options: TrailTrackerOptions) {
+    this.options = options;
+  }
+
+  public get(vehicleId: string): TrailBuffer | undefined {
+    return this.trails.get(vehicleId);
+  }
+
+  public isTracked(vehicleId: string): boolean {
+    return this.tracked.has(vehicleId);
+  }
+
+  public onChange(handler: TrailChangeHandler): () => void {
+    this.handlers.add(handler);
+    return () => this.handlers.delete(handler);
+  }
+
+  public setTracked(vehicleIds: Iterable<string>): void {
+    const previous = this.tracked;
+    this.tracked = new Set(vehicleIds);
+    this.tracked.forEach(id => this.touch(id));
+    const changed: string[] = [];
+    previous.forEach(id => {
+      if (!this.tracked.has(id)) changed.push(id);
+    });
+    this.tracked.forEach(id => {
+      if (!previous.has(id)) changed.push(id);
+    });
+    this.notify(changed, this.enforceBudget());
+  }
+
+  public apply(vehicles: Iterable<VehicleData>): void {
+    const changed: string[] = [];
+    for (const vehicle of vehicles) {
+      if (!this.tracked.has(vehicle.id)) continue;
+      let trail = this.trails.get(vehicle.id);
+      if (!trail) {
+        trail = new TrailBuffer(this.options.capacity);
+        this.trails.set(vehicle.id, trail);
+      }
+      // Device time where valid, so replayed trails span replay time
+      const time = Date.parse(vehicle.timestamp) || vehicle.lastUpdate;
+      const first = trail.firstSeq;
+      const pushed = trail.push(vehicle.latitude, vehicle.longitude, time);
+      trail.pruneBefore(time - this.options.windowMs);
+      if (pushed || trail.firstSeq !== first) changed.push(vehicle.id);
+    }
+    if (changed.length > 0) this.notify(changed, this.enforceBudget());
+  }
+
+  public clear(): void {
+    const evicted = Array.from(this.trails.keys());
+    this.trails.clear();
+    this.notify([], evicted);
+  }
+
+  private touch(vehicleId: string): void {
+    const trail = this.trails.get(vehicleId);
+    if (trail) {
+      this.trails.delete(vehicleId);
+      this.trails.set(vehicleId, trail);
+    }
+  }
+
+  // Tracked vehicles are exempt, so the budget can be exceeded only by tracked trails
+  private enforceBudget(): string[] {
+    const evicted: string[] = [];
+    let allocated = this.trails.size * this.options.capacity;
+    for (const id of this.trails.keys()) {
+      if (allocated <= this.options.budget) break;
+      if (this.tracked.has(id)) continue;
+      this.trails.delete(id);
+      evicted.push(id);
+      allocated -= this.options.capacity;
+    }
+    return evicted;
+  }
+
+  private notify(changed: string[], evicted: string[]): void {
+    if (changed.length === 0 && evicted.length === 0) return;
+    this.handlers.forEach(handler => handler(changed, evicted));
+  }
+}
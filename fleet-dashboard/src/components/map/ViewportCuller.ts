@@ -0,0 +1,82 @@
+import { VehicleData, GeoBounds } from '../../types';
+import { SpatialGrid, containsPoint } from '../../utils/spatialGrid';
+import { VehicleLayerSink } from './bindLayerToStore';
+
+/**
+ * Sink decorator that only lets vehicles inside the (padded) viewport reach
+ * the wrapped layer. Every vehicle seen is kept in a spatial grid, so a pan
+ * or zoom materializes and drops markers by visiting the overlapped cells
+ * instead of scanning the fleet.
+ */
+export class ViewportCuller implements VehicleLayerSink {
+  private grid = new SpatialGrid();
+  private inside: Set<string> = new Set();
+  private bounds: GeoBounds | null;
+  private isVisible: (vehicle: VehicleData) => boolean = () => true;
+  private sink: VehicleLayerSink;
+  private lookup: (id: string) => VehicleData | undefined;
+
+  constructor(
+    sink: VehicleLayerSink,
+    lookup: (id: string) => VehicleData | undefined,
+    bounds: GeoBounds | null = null
+  ) {
+    this.sink = sink;
+    this.lookup = lookup;
+    this.bounds = bounds;
+  }
+
+  public apply(vehicles: Iterable<VehicleData>, isVisible: (vehicle: VehicleData) => boolean): void {
+    this.isVisible = isVisible;
+    const list = Array.isArray(vehicles) ? vehicles : Array.from(vehicles);
+
+    list.forEach(vehicle => {
+      this.grid.upsert(vehicle.id, vehicle.latitude, vehicle.longitude);
+      if (this.contains(vehicle)) {
+        this.inside.add(vehicle.id);
+      } else {
+        this.inside.delete(vehicle.id);
+      }
+    });
+
+    this.sink.apply(list, this.isMaterialized);
+  }
+
+  public clear(): void {
+    this.grid.clear();
+    this.inside.clear();
+    this.sink.clear();
+  }
+
+  // Forwards only the vehicles that crossed the viewport edge since the last bounds
+  public setBounds(bounds: GeoBounds): void {
+    this.bounds = bounds;
+    const next: Set<string> = new Set();
+    this.grid.query(bounds, id => {
+      const vehicle = this.lookup(id);
+      if (vehicle && containsPoint(bounds, vehicle.latitude, vehicle.longitude)) next.add(id);
+    });
+
+    const crossed: VehicleData[] = [];
+    const collect = (id: string) => {
+      const vehicle = this.lookup(id);
+      if (vehicle) crossed.push(vehicle);
+    };
+    this.inside.forEach(id => {
+      if (!next.has(id)) collect(id);
+    });
+    next.forEach(id => {
+      if (!this.inside.has(id)) collect(id);
+    });
+
+    this.inside = next;
+    if (crossed.length > 0) this.sink.apply(crossed, this.isMaterialized);
+  }
+
+  private contains(vehicle: VehicleData): boolean {
+    return !this.bounds || containsPoint(this.bounds, vehicle.latitude, vehicle.longitude);
+  }
+
+  private isMaterialized = (vehicle: VehicleData): boolean =>
+    this.inside.has(vehicle.id) && this.isVisible(vehicle);
+}
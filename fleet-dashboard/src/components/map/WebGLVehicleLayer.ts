@@ -0,0 +1,347 @@
+import L from 'leaflet';
+import { VehicleData } from '../../types';
+import { STATUS_CODES, encodeStatus, STATUS_ABSENT } from '../../utils/telemetryCodec';
+import { projectToWorld } from '../../utils/mercator';
+import { STATUS_COLORS, DEFAULT_STATUS_COLOR, vehiclePopupHtml } from './vehicleStyle';
+import { VehicleLayerSink } from './bindLayerToStore';
+import { PerfHistogram, perfMeasure, perfStart } from '../../utils/perfMetrics';
+
+// Per vertex: world x/y split into high and low float32 parts, then the status code (-1 = hidden)
+const FLOATS_PER_VERTEX = 5;
+const INITIAL_CAPACITY = 1024;
+const POINT_SIZE_PX = 12;
+const HIT_RADIUS_PX = 8;
+const TILE_SIZE = 256;
+const PANE_NAME = 'vehicleGLPane';
+// Above overlays (400), below DOM markers (600) and popups (700)
+const PANE_Z_INDEX = '450';
+// Past this share of dirty slots one upload of the used range beats per-run uploads
+const FULL_UPLOAD_SHARE = 0.25;
+
+const VERTEX_SHADER = `
+attribute vec2 a_hi;
+attribute vec2 a_lo;
+attribute float a_status;
+uniform vec2 u_centerHi;
+uniform vec2 u_centerLo;
+uniform float u_scale;
+uniform vec2 u_halfSize;
+uniform float u_pointSize;
+varying float v_status;
+
+void main() {
+  v_status = a_status;
+  if (a_status < 0.0) {
+    gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+    gl_PointSize = 0.0;
+    return;
+  }
+  // Subtract high and low parts separately to keep precision at street-level zooms
+  vec2 px = ((a_hi - u_centerHi) + (a_lo - u_centerLo)) * u_scale;
+  gl_Position = vec4(px.x / u_halfSize.x, -px.y / u_halfSize.y, 0.0, 1.0);
+  gl_PointSize = u_pointSize;
+}
+`;
+
+const FRAGMENT_SHADER = `
+precision mediump float;
+uniform vec3 u_colors[${STATUS_CODES.length + 1}];
+varying float v_status;
+
+void main() {
+  vec2 p = gl_PointCoord * 2.0 - 1.0;
+  float r = dot(p, p);
+  if (r > 1.0) discard;
+
+  int code = int(v_status + 0.5);
+  vec3 color = u_colors[${STATUS_CODES.length}];
+  for (int i = 0; i < ${STATUS_CODES.length}; i++) {
+    if (i == code) color = u_colors[i];
+  }
+  gl_FragColor = vec4(r > 0.55 ? vec3(1.0) : color, 1.0);
+}
+`;
+
+const hexToRgb = (hex: string): [number, number, number] => {
+  const value = parseInt(hex.slice(1), 16);
+  return [((value >> 16) & 255) / 255, ((value >> 8) & 255) / 255, (value & 255) / 255];
+};
+
+const compileShader = (gl: WebGLRenderingContext, type: number, source: string): WebGLShader => {
+  const shader = gl.createShader(type)!;
+  gl.shaderSource(shader, source);
+  gl.compileShader(shader);
+  if (!gl.getShaderParameter(shader, gl.COMPILE_STATUS)) {
+    throw new Error(`Vehicle layer shader failed to compile: ${gl.getShaderInfoLog(shader)}`);
+  }
+  return shader;
+};
+
+/**
+ * Draws every vehicle as a GPU point sprite from a typed vertex buffer. Each
+ * vehicle owns a fixed slot; upserts rewrite only that slot's vertex and the
+ * next frame uploads just the dirty runs of slots with bufferSubData, or the
+ * whole used range at once when most of it changed. Clicks are
+ * hit-tested against the same buffer and open a regular Leaflet popup.
+ */
+export class WebGLVehicleLayer extends L.Layer implements VehicleLayerSink {
+  private leafletMap: L.Map | null = null;
+  private canvas: HTMLCanvasElement | null = null;
+  private gl: WebGLRenderingContext | null = null;
+  private program: WebGLProgram | null = null;
+  private buffer: WebGLBuffer | null = null;
+  private uniforms: Record<string, WebGLUniformLocation | null> = {};
+
+  private slots: Map<string, number> = new Map();
+  private vehicles: Array<VehicleData | undefined> = [];
+  private vertices = new Float32Array(INITIAL_CAPACITY * FLOATS_PER_VERTEX);
+  private dirtySlots: Set<number> = new Set();
+  private bufferStale: boolean = true;
+  private frame: number | null = null;
+
+  public onAdd(map: L.Map): this {
+    this.leafletMap = map;
+
+    const pane = map.getPane(PANE_NAME) ?? map.createPane(PANE_NAME);
+    pane.style.zIndex = PANE_Z_INDEX;
+    pane.style.pointerEvents = 'none';
+
+    this.canvas = L.DomUtil.create('canvas', 'leaflet-zoom-hide') as HTMLCanvasElement;
+    pane.appendChild(this.canvas);
+    this.initGL(this.canvas);
+
+    map.on('move zoom viewreset', this.requestRender, this);
+    map.on('resize', this.resize, this);
+    map.on('click', this.handleClick, this);
+    this.resize();
+    return this;
+  }
+
+  public onRemove(map: L.Map): this {
+    map.off('move zoom viewreset', this.requestRender, this);
+    map.off('resize', this.resize, this);
+    map.off('click', this.handleClick, this);
+    if (this.frame !== null) cancelAnimationFrame(this.frame);
+    this.frame = null;
+    if (this.gl) {
+      this.gl.deleteBuffer(this.buffer);
+      this.gl.deleteProgram(this.program);
+    }
+    this.buffer = null;
+    this.program = null;
+    this.canvas?.remove();
+    this.canvas = null;
+    this.gl = null;
+    this.leafletMap = null;
+    this.bufferStale = true;
+    return this;
+  }
+
+  public apply(vehicles: Iterable<VehicleData>, isVisible: (vehicle: VehicleData) => boolean): void {
+    const start = perfStart();
+    for (const vehicle of vehicles) {
+      this.upsert(vehicle, isVisible(vehicle));
+    }
+    perfMeasure(PerfHistogram.MAP_UPDATE, start);
+  }
+
+  public upsert(vehicle: VehicleData, visible: boolean): void {
+    let slot = this.slots.get(vehicle.id);
+    if (slot === undefined) {
+      slot = this.vehicles.length;
+      this.slots.set(vehicle.id, slot);
+      this.ensureCapacity(slot + 1);
+    }
+    this.vehicles[slot] = vehicle;
+
+    const [x, y] = projectToWorld(vehicle.latitude, vehicle.longitude);
+    const xHi = Math.fround(x);
+    const yHi = Math.fround(y);
+    const base = slot * FLOATS_PER_VERTEX;
+    this.vertices[base] = xHi;
+    this.vertices[base + 1] = yHi;
+    this.vertices[base + 2] = x - xHi;
+    this.vertices[base + 3] = y - yHi;
+    const code = encodeStatus(vehicle.status);
+    this.vertices[base + 4] = visible ? (code === STATUS_ABSENT ? STATUS_CODES.length : code) : -1;
+
+    this.dirtySlots.add(slot);
+    this.requestRender();
+  }
+
+  public clear(): void {
+    this.slots.clear();
+    this.vehicles = [];
+    this.vertices.fill(0);
+    this.dirtySlots.clear();
+    this.bufferStale = true;
+    this.requestRender();
+  }
+
+  private ensureCapacity(count: number): void {
+    if (count * FLOATS_PER_VERTEX <= this.vertices.length) return;
+    let capacity = this.vertices.length / FLOATS_PER_VERTEX;
+    while (capacity < count) capacity *= 2;
+    const grown = new Float32Array(capacity * FLOATS_PER_VERTEX);
+    grown.set(this.vertices);
+    this.vertices = grown;
+    this.bufferStale = true;
+  }
+
+  private initGL(canvas: HTMLCanvasElement): void {
+    const gl = canvas.getContext('webgl', { premultipliedAlpha: false, antialias: true });
+    if (!gl) {
+      throw new Error('WebGL is not available for the vehicle layer');
+    }
+
+    const program = gl.createProgram()!;
+    const shaders = [
+      compileShader(gl, gl.VERTEX_SHADER, VERTEX_SHADER),
+      compileShader(gl, gl.FRAGMENT_SHADER, FRAGMENT_SHADER)
+    ];
+    shaders.forEach(shader => gl.attachShader(program, shader));
+    gl.linkProgram(program);
+    // The linked program keeps what it needs; the shaders go with it when it is deleted
+    shaders.forEach(shader => gl.deleteShader(shader));
+    if (!gl.getProgramParameter(program, gl.LINK_STATUS)) {
+      throw new Error(`Vehicle layer program failed to link: ${gl.getProgramInfoLog(program)}`);
+    }
+    gl.useProgram(program);
+
+    this.buffer = gl.createBuffer();
+    gl.bindBuffer(gl.ARRAY_BUFFER, this.buffer);
+
+    const stride = FLOATS_PER_VERTEX * 4;
+    const attributes: Array<[string, number, number]> = [['a_hi', 2, 0], ['a_lo', 2, 8], ['a_status', 1, 16]];
+    attributes.forEach(([name, size, offset]) => {
+      const location = gl.getAttribLocation(program, name);
+      gl.enableVertexAttribArray(location);
+      gl.vertexAttribPointer(location, size, gl.FLOAT, false, stride, offset);
+    });
+
+    ['u_centerHi', 'u_centerLo', 'u_scale', 'u_halfSize', 'u_pointSize', 'u_colors'].forEach(name => {
+      this.uniforms[name] = gl.getUniformLocation(program, name);
+    });
+
+    const colors = new Float32Array((STATUS_CODES.length + 1) * 3);
+    STATUS_CODES.forEach((status, code) => colors.set(hexToRgb(STATUS_COLORS[status]), code * 3));
+    colors.set(hexToRgb(DEFAULT_STATUS_COLOR), STATUS_CODES.length * 3);
+    gl.uniform3fv(this.uniforms.u_colors, colors);
+
+    gl.enable(gl.BLEND);
+    gl.blendFunc(gl.SRC_ALPHA, gl.ONE_MINUS_SRC_ALPHA);
+
+    this.gl = gl;
+    this.program = program;
+    this.bufferStale = true;
+  }
+
+  private resize(): void {
+    if (!this.leafletMap || !this.canvas) return;
+    const size = this.leafletMap.getSize();
+    const ratio = window.devicePixelRatio || 1;
+    this.canvas.width = size.x * ratio;
+    this.canvas.height = size.y * ratio;
+    this.canvas.style.width = `${size.x}px`;
+    this.canvas.style.height = `${size.y}px`;
+    this.requestRender();
+  }
+
+  private requestRender(): void {
+    if (this.frame === null && this.gl) {
+      this.frame = requestAnimationFrame(() => {
+        this.frame = null;
+        this.render();
+      });
+    }
+  }
+
+  private uploadVertices(gl: WebGLRenderingContext): void {
+    if (this.bufferStale) {
+      gl.bufferData(gl.ARRAY_BUFFER, this.vertices, gl.DYNAMIC_DRAW);
+      this.bufferStale = false;
+    } else if (this.dirtySlots.size > this.vehicles.length * FULL_UPLOAD_SHARE) {
+      gl.bufferSubData(gl.ARRAY_BUFFER, 0, this.vertices.subarray(0, this.vehicles.length * FLOATS_PER_VERTEX));
+    } else if (this.dirtySlots.size > 0) {
+      // One call per run of adjacent dirty slots
+      const slots = Array.from(this.dirtySlots).sort((a, b) => a - b);
+      let runStart = slots[0];
+      for (let i = 1; i <= slots.length; i++) {
+        if (i < slots.length && slots[i] === slots[i - 1] + 1) continue;
+        this.uploadSlots(gl, runStart, slots[i - 1] + 1);
+        runStart = slots[i];
+      }
+    }
+    this.dirtySlots.clear();
+  }
+
+  private uploadSlots(gl: WebGLRenderingContext, from: number, to: number): void {
+    const start = from * FLOATS_PER_VERTEX;
+    gl.bufferSubData(gl.ARRAY_BUFFER, start * 4, this.vertices.subarray(start, to * FLOATS_PER_VERTEX));
+  }
+
+  private render(): void {
+    const gl = this.gl;
+    const map = this.leafletMap;
+    if (!gl || !map || !this.canvas || !this.program) return;
+
+    // Keep the canvas pinned to the container while the map pane is panned
+    L.DomUtil.setPosition(this.canvas, map.containerPointToLayerPoint([0, 0]));
+
+    this.uploadVertices(gl);
+
+    const size = map.getSize();
+    const center = map.getCenter();
+    const [cx, cy] = projectToWorld(center.lat, center.lng);
+    const cxHi = Math.fround(cx);
+    const cyHi = Math.fround(cy);
+    const ratio = window.devicePixelRatio || 1;
+
+    gl.viewport(0, 0, this.canvas.width, this.canvas.height);
+    gl.clearColor(0, 0, 0, 0);
+    gl.clear(gl.COLOR_BUFFER_BIT);
+    gl.uniform2f(this.uniforms.u_centerHi, cxHi, cyHi);
+    gl.uniform2f(this.uniforms.u_centerLo, cx - cxHi, cy - cyHi);
+    gl.uniform1f(this.uniforms.u_scale, TILE_SIZE * Math.pow(2, map.getZoom()));
+    gl.uniform2f(this.uniforms.u_halfSize, size.x / 2, size.y / 2);
+    gl.uniform1f(this.uniforms.u_pointSize, POINT_SIZE_PX * ratio);
+    gl.drawArrays(gl.POINTS, 0, this.vehicles.length);
+  }
+
+  private handleClick(event: L.LeafletMouseEvent): void {
+    const vehicle = this.findNearest(event.containerPoint);
+    if (vehicle && this.leafletMap) {
+      L.popup({ offset: [0, -POINT_SIZE_PX / 2] })
+        .setLatLng([vehicle.latitude, vehicle.longitude])
+        .setContent(vehiclePopupHtml(vehicle))
+        .openOn(this.leafletMap);
+    }
+  }
+
+  // Linear scan over the vertex buffer; runs only on click
+  private findNearest(point: L.Point): VehicleData | undefined {
+    const map = this.leafletMap;
+    if (!map) return undefined;
+
+    const size = map.getSize();
+    const center = map.getCenter();
+    const [cx, cy] = projectToWorld(center.lat, center.lng);
+    const scale = TILE_SIZE * Math.pow(2, map.getZoom());
+    let best: VehicleData | undefined;
+    let bestDistance = HIT_RADIUS_PX * HIT_RADIUS_PX;
+
+    for (let slot = 0; slot < this.vehicles.length; slot++) {
+      const base = slot * FLOATS_PER_VERTEX;
+      if (this.vertices[base + 4] < 0) continue;
+      const x = (this.vertices[base] + this.vertices[base + 2] - cx) * scale + size.x / 2;
+      const y = (this.vertices[base + 1] + this.vertices[base + 3] - cy) * scale + size.y / 2;
+      const distance = (x - point.x) ** 2 + (y - point.y) ** 2;
+      if (distance <= bestDistance) {
+        bestDistance = distance;
+        best = this.vehicles[slot];
+      }
+    }
+
+    return best;
+  }
+}
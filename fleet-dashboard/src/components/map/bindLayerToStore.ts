@@ -0,0 +1,58 @@
+import { VehicleData } from '../../types';
+import { useFleetStore, subscribeVehicleDeltas } from '../../stores/fleetStore';
+import { matchesFilters, sameFilterCriteria } from '../../utils/filterIndex';
+import { ViewportCuller } from './ViewportCuller';
+
+// Map layer kept in step with the store outside React rendering
+export interface VehicleLayerSink {
+  // Writes the given vehicles; `isVisible` tells whether each passes the current filters
+  apply(vehicles: Iterable<VehicleData>, isVisible: (vehicle: VehicleData) => boolean): void;
+  clear(): void;
+}
+
+export interface BindLayerOptions {
+  // Only materialize vehicles inside the viewport the map last reported to the store
+  cullToViewport?: boolean;
+}
+
+/**
+ * Seeds the layer with the current fleet, then forwards only the vehicles in
+ * each store delta. A filter change re-applies the whole fleet once so
+ * visibility is re-evaluated; a viewport change only forwards the vehicles
+ * that crossed its edge. Returns the unsubscribe function.
+ */
+export const bindLayerToStore = (
+  layer: VehicleLayerSink,
+  options: BindLayerOptions = {}
+): (() => void) => {
+  let { filters, viewport } = useFleetStore.getState();
+  const isVisible = (vehicle: VehicleData) => matchesFilters(vehicle, filters);
+  const culler = options.cullToViewport
+    ? new ViewportCuller(layer, id => useFleetStore.getState().vehicles.get(id), viewport)
+    : null;
+  const sink = culler ?? layer;
+
+  sink.apply(useFleetStore.getState().vehicles.values(), isVisible);
+
+  const unsubscribeDeltas = subscribeVehicleDeltas((delta) => {
+    if (delta.cleared) sink.clear();
+    // Deleted vehicles are hidden like filtered-out ones
+    if (delta.removed.length > 0) sink.apply(delta.removed, () => false);
+    if (delta.changed.length > 0) sink.apply(delta.changed, isVisible);
+  });
+  const unsubscribeFilters = useFleetStore.subscribe((state) => {
+    if (state.filters !== filters && !sameFilterCriteria(state.filters, filters)) {
+      filters = state.filters;
+      sink.apply(state.vehicles.values(), isVisible);
+    }
+    if (culler && state.viewport && state.viewport !== viewport) {
+      viewport = state.viewport;
+      culler.setBounds(viewport);
+    }
+  });
+
+  return () => {
+    unsubscribeDeltas();
+    unsubscribeFilters();
+  };
+};
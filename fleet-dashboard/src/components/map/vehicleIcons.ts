@@ -0,0 +1,47 @@
+import L from 'leaflet';
+import { VehicleStatus } from '../../types';
+import { STATUS_COLORS, DEFAULT_STATUS_COLOR } from './vehicleStyle';
+
+const VEHICLE_GLYPH = `
+  <svg width="12" height="12" viewBox="0 0 20 20" fill="white">
+    <path d="M8 16.5a1.5 1.5 0 11-3 0 1.5 1.5 0 013 0zM15 16.5a1.5 1.5 0 11-3 0 1.5 1.5 0 013 0z" />
+    <path d="M3 4a1 1 0 00-1 1v10a1 1 0 001 1h1.05a2.5 2.5 0 014.9 0H10a1 1 0 001-1V5a1 1 0 00-1-1H3zM14 7a1 1 0 00-1 1v6.05A2.5 2.5 0 0115.95 16H17a1 1 0 001-1v-5a1 1 0 00-.293-.707l-2-2A1 1 0 0015 7h-1z" />
+  </svg>
+`;
+
+const createVehicleIcon = (color: string) => L.divIcon({
+  className: 'custom-vehicle-marker',
+  html: `<div class="vehicle-marker" style="background-color: ${color}">${VEHICLE_GLYPH}</div>`,
+  iconSize: [24, 24],
+  iconAnchor: [12, 12],
+  popupAnchor: [0, -12],
+});
+
+// Built once per status; marker updates then reuse the same icon instance and
+// Leaflet only moves the existing element instead of rebuilding it
+const VEHICLE_ICONS = Object.fromEntries(
+  Object.values(VehicleStatus).map(status => [status, createVehicleIcon(STATUS_COLORS[status])])
+) as Record<VehicleStatus, L.DivIcon>;
+
+const FALLBACK_ICON = createVehicleIcon(DEFAULT_STATUS_COLOR);
+
+export const getVehicleIcon = (status: VehicleStatus): L.DivIcon => VEHICLE_ICONS[status] ?? FALLBACK_ICON;
+
+const clusterIcons: Map<string, L.DivIcon> = new Map();
+
+// Sized by count magnitude; cached by label so clusters with the same label share one icon
+export const getClusterIcon = (count: number): L.DivIcon => {
+  const label = count >= 1000 ? `${Math.round(count / 100) / 10}k` : String(count);
+  let icon = clusterIcons.get(label);
+  if (!icon) {
+    const size = count >= 1000 ? 44 : count >= 100 ? 36 : 28;
+    icon = L.divIcon({
+      className: 'cluster-summary-marker',
+      html: `<div class="cluster-summary" style="width: ${size}px; height: ${size}px">${label}</div>`,
+      iconSize: [size, size],
+      iconAnchor: [size / 2, size / 2]
+    });
+    clusterIcons.set(label, icon);
+  }
+  return icon;
+};
@@ -0,0 +1,30 @@
+import { VehicleData, VehicleStatus } from '../../types';
+
+export const STATUS_COLORS: Record<VehicleStatus, string> = {
+  [VehicleStatus.MOVING]: '#10b981',
+  [VehicleStatus.ONLINE]: '#3b82f6',
+  [VehicleStatus.STOPPED]: '#f59e0b',
+  [VehicleStatus.OFFLINE]: '#6b7280',
+  [VehicleStatus.LOW_BATTERY]: '#ef4444',
+};
+
+export const DEFAULT_STATUS_COLOR = '#6b7280';
+
+export const formatStatus = (status: VehicleStatus) => status.replace(/_/g, ' ').toLowerCase();
+
+const escapeHtml = (value: string) =>
+  value.replace(/[&<>"']/g, (char) => `&#${char.charCodeAt(0)};`);
+
+// Popup markup for map layers that are not rendered through React
+export const vehiclePopupHtml = (vehicle: VehicleData) => `
+  <div class="p-2 min-w-[200px]">
+    <h3 class="font-bold text-gray-900 mb-2">${escapeHtml(vehicle.id)}</h3>
+    <div class="space-y-1 text-sm">
+      <div class="flex justify-between"><span class="text-gray-600">Speed:</span><span class="font-medium">${vehicle.speed.toFixed(1)} km/h</span></div>
+      <div class="flex justify-between"><span class="text-gray-600">Battery:</span><span class="font-medium">${vehicle.battery.toFixed(0)}%</span></div>
+      <div class="flex justify-between"><span class="text-gray-600">Altitude:</span><span class="font-medium">${vehicle.altitude?.toFixed(0) || 'N/A'} m</span></div>
+      <div class="flex justify-between"><span class="text-gray-600">Satellites:</span><span class="font-medium">${vehicle.satellites || 'N/A'}</span></div>
+      <div class="flex justify-between"><span class="text-gray-600">Status:</span><span class="font-medium capitalize">${escapeHtml(formatStatus(vehicle.status))}</span></div>
+    </div>
+  </div>
+`;
@@ -0,0 +1,34 @@
+import { useCallback, useEffect, useState } from 'react';
+
+interface ElementSize {
+  width: number;
+  height: number;
+}
+
+// Content-box size of the element given to the returned callback ref, kept
+// current with a ResizeObserver. A callback ref lets the element mount later
+// (e.g. after an empty state) and still be observed.
+export const useElementSize = <T extends HTMLElement>() => {
+  const [element, setElement] = useState<T | null>(null);
+  const [size, setSize] = useState<ElementSize>({ width: 0, height: 0 });
+  const ref = useCallback((node: T | null) => setElement(node), []);
+
+  useEffect(() => {
+    if (!element) return;
+
+    const update = (width: number, height: number) => {
+      setSize(prev => (prev.width === width && prev.height === height ? prev : { width, height }));
+    };
+    update(element.clientWidth, element.clientHeight);
+
+    if (typeof ResizeObserver === 'undefined') return;
+    const observer = new ResizeObserver(entries => {
+      const { width, height } = entries[0].contentRect;
+      update(Math.round(width), Math.round(height));
+    });
+    observer.observe(element);
+    return () => observer.disconnect();
+  }, [element]);
+
+  return [ref, size] as const;
+};
@@ -0,0 +1,87 @@
+import { useSyncExternalStore } from 'react';
+import { useFleetStore, subscribeVehicleDeltas, fleetCountsOf } from '../stores/fleetStore';
+import { FleetAnalytics } from '../api/restClient';
+import { TimeRange, VehicleStatus } from '../types';
+import { RollupPoint, StreamingFleetAnalytics, WindowAggregate } from '../utils/fleetAnalytics';
+
+const TICK_MS = 1000;
+
+export interface FleetKpis extends FleetAnalytics {
+  speedStdDev: number;
+  lastFiveMinutes: WindowAggregate;
+  lastHour: WindowAggregate;
+  rollups: Record<TimeRange, RollupPoint[]>;
+  // Telemetry time the windows end at
+  asOf: number;
+}
+
+const analytics = new StreamingFleetAnalytics();
+const listeners: Set<() => void> = new Set();
+let snapshot: FleetKpis | null = null;
+let stop: (() => void) | null = null;
+
+const takeSnapshot = (): FleetKpis => {
+  const counts = fleetCountsOf(useFleetStore.getState());
+  const asOf = analytics.asOf;
+  return {
+    totalVehicles: counts.total,
+    onlineVehicles: counts.online,
+    movingVehicles: counts.byStatus[VehicleStatus.MOVING] ?? 0,
+    lowBatteryVehicles: counts.lowBattery,
+    averageSpeed: analytics.speed.mean,
+    averageBattery: analytics.battery.mean,
+    totalDistance: analytics.totalDistanceKm,
+    speedStdDev: analytics.speed.stdDev,
+    lastFiveMinutes: analytics.lastFiveMinutes.total(asOf),
+    lastHour: analytics.lastHour.total(asOf),
+    rollups: {
+      [TimeRange.LAST_HOUR]: analytics.rollups[TimeRange.LAST_HOUR].series(asOf),
+      [TimeRange.LAST_24H]: analytics.rollups[TimeRange.LAST_24H].series(asOf),
+      [TimeRange.LAST_WEEK]: analytics.rollups[TimeRange.LAST_WEEK].series(asOf),
+      [TimeRange.CUSTOM]: analytics.rollups[TimeRange.CUSTOM].series(asOf)
+    },
+    asOf
+  };
+};
+
+// Fed from store deltas while anything is subscribed; seeded with the fleet as it is
+const start = (): (() => void) => {
+  analytics.apply(useFleetStore.getState().vehicles.values());
+  const unsubscribeDeltas = subscribeVehicleDeltas((delta) => {
+    if (delta.cleared) analytics.clear();
+    analytics.remove(delta.removed);
+    analytics.apply(delta.changed);
+  });
+  const timer = setInterval(() => {
+    analytics.sample(useFleetStore.getState().counts.byStatus[VehicleStatus.MOVING] ?? 0);
+    snapshot = takeSnapshot();
+    listeners.forEach(notify => notify());
+  }, TICK_MS);
+
+  return () => {
+    unsubscribeDeltas();
+    clearInterval(timer);
+    analytics.clear();
+    snapshot = null;
+  };
+};
+
+const subscribe = (listener: () => void): (() => void) => {
+  listeners.add(listener);
+  if (!stop) stop = start();
+  return () => {
+    listeners.delete(listener);
+    if (listeners.size === 0 && stop) {
+      stop();
+      stop = null;
+    }
+  };
+};
+
+const getSnapshot = (): FleetKpis => {
+  if (!snapshot) snapshot = takeSnapshot();
+  return snapshot;
+};
+
+// Streaming fleet KPIs, refreshed once a second for all subscribers together
+export const useFleetAnalytics = (): FleetKpis => useSyncExternalStore(subscribe, getSnapshot);
@@ -0,0 +1,31 @@
+import { useSyncExternalStore } from 'react';
+
+// One interval shared by every subscriber; started on first use, stopped when the last unmounts
+const TICK_MS = 1000;
+
+const listeners: Set<() => void> = new Set();
+let now = Date.now();
+let timer: ReturnType<typeof setInterval> | null = null;
+
+const subscribe = (listener: () => void): (() => void) => {
+  listeners.add(listener);
+  if (!timer) {
+    now = Date.now();
+    timer = setInterval(() => {
+      now = Date.now();
+      listeners.forEach(notify => notify());
+    }, TICK_MS);
+  }
+  return () => {
+    listeners.delete(listener);
+    if (listeners.size === 0 && timer) {
+      clearInterval(timer);
+      timer = null;
+    }
+  };
+};
+
+const getSnapshot = () => now;
+
+// Current time, refreshed once a second for all components together
+export const useNow = (): number => useSyncExternalStore(subscribe, getSnapshot);
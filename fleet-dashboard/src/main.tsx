@@ -1,10 +1,32 @@
 import React from 'react';
 import ReactDOM from 'react-dom/client';
 import App from './App';
+import { WarmStartCache } from './stores/warmStartCache';
+import { exposeMetricsForBenchmark } from './utils/perfMetrics';
 import './index.css';
 
-ReactDOM.createRoot(document.getElementById('root')!).render(
-  <React.StrictMode>
-    <App />
-  </React.StrictMode>,
-);
+// Paint the last saved fleet from IndexedDB before the socket (opened by App) connects
+const WARM_START = import.meta.env.VITE_WARM_START === 'true';
+// Longest the first render waits for the snapshot; a slower load is discarded
+const WARM_START_WAIT_MS = 500;
+
+// Set by `npm run bench` builds, which read metrics from the page
+if (import.meta.env.VITE_BENCHMARK === 'true') exposeMetricsForBenchmark();
+
+const render = () => {
+  ReactDOM.createRoot(document.getElementById('root')!).render(
+    <React.StrictMode>
+      <App />
+    </React.StrictMode>,
+  );
+};
+
+if (WARM_START && typeof indexedDB !== 'undefined') {
+  const warmStart = new WarmStartCache();
+  warmStart.restore(WARM_START_WAIT_MS).finally(() => {
+    warmStart.start();
+    render();
+  });
+} else {
+  render();
+}
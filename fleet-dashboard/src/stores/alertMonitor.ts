@@ -0,0 +1,67 @@
+import { AlertRule, AlertType } from '../types';
+import { RestApiClient } from '../api/restClient';
+import { AlertEngine } from '../utils/alertEngine';
+import { useFleetStore, subscribeVehicleDeltas } from './fleetStore';
+
+// Staleness timers are swept this often; alerts fire at most this late
+const TICK_MS = 1000;
+
+// In force until the configured rules load, and if they cannot be loaded
+export const DEFAULT_ALERT_RULES: AlertRule[] = [
+  { id: 'stale', type: AlertType.STALE, afterMs: 2 * 60 * 1000 }
+];
+
+/**
+ * Runs the alert engine on the live stream: every store delta is evaluated
+ * as it is written and the resulting alerts are pushed to the store. Replayed
+ * history is not evaluated, and the engine forgets the fleet whenever the
+ * table is cleared, so a replay never leaves enter/exit state behind.
+ */
+export class AlertMonitor {
+  private client: RestApiClient;
+  private engine = new AlertEngine(DEFAULT_ALERT_RULES);
+  private unsubscribe: (() => void) | null = null;
+  private abort: AbortController | null = null;
+
+  constructor(client: RestApiClient) {
+    this.client = client;
+  }
+
+  public start(): void {
+    if (this.unsubscribe) return;
+    const { vehicles, pushAlerts } = useFleetStore.getState();
+    this.engine.clear();
+    this.engine.apply(vehicles.values());
+
+    const unsubscribeAlerts = this.engine.onAlert(pushAlerts);
+    const unsubscribeDeltas = subscribeVehicleDeltas((delta) => {
+      if (delta.cleared) this.engine.clear();
+      if (delta.removed.length > 0) this.engine.remove(delta.removed.map(vehicle => vehicle.id));
+      if (!useFleetStore.getState().replayActive) this.engine.apply(delta.changed);
+    });
+    const timer = setInterval(() => {
+      if (!useFleetStore.getState().replayActive) this.engine.tick();
+    }, TICK_MS);
+    this.unsubscribe = () => {
+      unsubscribeAlerts();
+      unsubscribeDeltas();
+      clearInterval(timer);
+    };
+
+    this.abort = new AbortController();
+    this.client.getAlertConfig({ signal: this.abort.signal })
+      .then(({ geofences, rules }) => {
+        this.engine.configure(rules.length > 0 ? rules : DEFAULT_ALERT_RULES, geofences);
+      })
+      .catch((error) => {
+        if (error?.name !== 'AbortError') console.error('Failed to load geofences and alert rules:', error);
+      });
+  }
+
+  public stop(): void {
+    this.abort?.abort();
+    this.abort = null;
+    this.unsubscribe?.();
+    this.unsubscribe = null;
+  }
+}
@@ -1,141 +1,402 @@
 import { create } from 'zustand';
-import { VehicleData, FilterState, VehicleStatus, TimeRange, ConnectionStatus } from '../types';
+import {
+  VehicleData,
+  VehicleUpdate,
+  FilterState,
+  VehicleStatus,
+  TimeRange,
+  SortField,
+  ConnectionStatus,
+  FleetCounts,
+  ViewportBounds,
+  ClusterSummary,
+  FleetAlert
+} from '../types';
+import { VehicleFilterIndex, matchesFilters, sameFilterCriteria } from '../utils/filterIndex';
+import { addToCounts, copyCounts, createCounts, recountVehicle } from '../utils/fleetCounts';
+import { VehicleSortIndex } from '../utils/vehicleSortIndex';
+import {
+  VehicleTable,
+  IndexedFields,
+  ObjectVehicleTable,
+  ColumnarVehicleTable,
+  VehicleView
+} from '../utils/vehicleTable';
+import { PerfHistogram, perfMeasure, perfStart } from '../utils/perfMetrics';
 
 interface FleetStore {
-  // Vehicle data
-  vehicles: Map<string, VehicleData>;
+  // Vehicle data, mutated in place; `vehiclesVersion` changes on every write
+  vehicles: VehicleTable;
+  vehiclesVersion: number;
+  
+  // Aggregate counters, updated by delta on every write
+  counts: FleetCounts;
+  // Counters of the whole fleet, set when the ingest source forwards only the vehicles
+  // this tab's filters select (shared mode); read through `fleetCountsOf`
+  fleetCounts: FleetCounts | null;
   
   // Filters
   filters: FilterState;
   
   // Connection status
   connectionStatus: ConnectionStatus;
+
+  // Padded map bounds reported by the map when viewport culling is enabled
+  viewport: ViewportBounds | null;
+  // Latest server aggregates for regions whose vehicles are not streamed at this zoom
+  clusterSummaries: ClusterSummary[];
+
+  // Vehicle highlighted in the list
+  selectedVehicleId: string | null;
+  // Vehicles whose trail is drawn even when not selected
+  pinnedVehicleIds: ReadonlySet<string>;
+
+  // Set while a historical replay owns `vehicles`; live updates are dropped meanwhile
+  replayActive: boolean;
+
+  // When `vehicles` was seeded from a warm-start snapshot; vehicles whose lastUpdate
+  // is older have not been confirmed by live data yet
+  hydratedAt: number | null;
+
+  // Alerts raised by the rules engine, newest first and bounded
+  alerts: FleetAlert[];
   
   // Actions
-  updateVehicle: (vehicleId: string, data: VehicleData) => void;
-  updateVehicles: (updates: Map<string, VehicleData>) => void;
+  updateVehicle: (vehicleId: string, data: VehicleUpdate) => void;
+  updateVehicles: (updates: Map<string, VehicleUpdate>) => void;
   setFilter: <K extends keyof FilterState>(key: K, value: FilterState[K]) => void;
   setConnectionStatus: (status: ConnectionStatus) => void;
+  setViewport: (viewport: ViewportBounds) => void;
+  setClusterSummaries: (summaries: ClusterSummary[]) => void;
+  selectVehicle: (vehicleId: string | null) => void;
+  togglePinnedVehicle: (vehicleId: string) => void;
+  setReplayActive: (active: boolean) => void;
+  // Seeds an empty store from a snapshot; vehicles keep their recorded lastUpdate
+  hydrate: (vehicles: VehicleData[], filters: FilterState, viewport: ViewportBounds | null) => void;
   clearVehicles: () => void;
+  // Drops vehicles the ingest source no longer forwards
+  removeVehicles: (vehicleIds: Iterable<string>) => void;
+  setFleetCounts: (counts: FleetCounts | null) => void;
+  pushAlerts: (alerts: FleetAlert[]) => void;
+  dismissAlert: (alertId: string) => void;
+  clearAlerts: () => void;
   
   // Computed/Derived data
   getFilteredVehicles: () => VehicleData[];
   getVehicleById: (id: string) => VehicleData | undefined;
+  // Positional access into the filtered list, in sort order (arrival order when unsorted)
+  getVehicleAt: (index: number) => VehicleData | undefined;
+  getVehicleSlice: (start: number, end: number) => VehicleData[];
   getVehiclesByStatus: (status: VehicleStatus) => VehicleData[];
   getOnlineCount: () => number;
   getLowBatteryCount: () => number;
 }
 
+// 'columnar' keeps vehicles in typed columns behind stable views instead of one object per update
+const VEHICLE_STORE = import.meta.env.VITE_VEHICLE_STORE || 'objects';
+
+// Older alerts are dropped once the feed holds this many
+const MAX_ALERTS = 200;
+
+const createVehicleTable = (): VehicleTable =>
+  VEHICLE_STORE === 'columnar' ? new ColumnarVehicleTable() : new ObjectVehicleTable();
+
+// Secondary indexes kept in step with `vehicles` by the update actions
+const filterIndex = new VehicleFilterIndex();
+// Ordered view of the filtered vehicles; only maintained while a sort is selected
+const sortIndex = new VehicleSortIndex();
+
+// Vehicles written by one update action, for consumers that apply changes
+// incrementally (map layers, indexes) instead of re-reading the whole fleet
+export interface VehicleDelta {
+  changed: VehicleData[];
+  // The table was emptied; consumers should drop everything they hold
+  cleared: boolean;
+  // Vehicles deleted from the table, as last written; consumers should drop them
+  removed: VehicleData[];
+}
+
+type VehicleDeltaListener = (delta: VehicleDelta) => void;
+
+const deltaListeners: Set<VehicleDeltaListener> = new Set();
+
+export const subscribeVehicleDeltas = (listener: VehicleDeltaListener): (() => void) => {
+  deltaListeners.add(listener);
+  return () => deltaListeners.delete(listener);
+};
+
+const emitVehicleDelta = (delta: VehicleDelta): void => {
+  deltaListeners.forEach(listener => listener(delta));
+};
+
+// Indexed fields of a vehicle before its write; reused because columnar views change in place
+const previousFields: IndexedFields = { status: VehicleStatus.OFFLINE, battery: 0 };
+
+// Merges one update into the table and keeps the indexes and counters in step.
+// Appends the merged vehicle to `changed` and returns true if the counters changed.
+const writeVehicle = (
+  vehicles: VehicleTable,
+  counts: FleetCounts,
+  filters: FilterState,
+  vehicleId: string,
+  data: VehicleUpdate,
+  now: number,
+  changed: VehicleData[]
+): boolean => {
+  const existing = vehicles.get(vehicleId);
+  if (existing) {
+    previousFields.status = existing.status;
+    previousFields.battery = existing.battery;
+  }
+  const previous = existing ? previousFields : undefined;
+  const next = vehicles.write(vehicleId, data, now);
+  filterIndex.upsert(previous, next);
+  if (sortIndex.active) sortIndex.upsert(next, matchesFilters(next, filters));
+  changed.push(next);
+  return recountVehicle(counts, previous, next);
+};
+
 export const useFleetStore = create<FleetStore>((set, get) => ({
-  vehicles: new Map(),
+  vehicles: createVehicleTable(),
+  vehiclesVersion: 0,
+  counts: createCounts(),
+  fleetCounts: null,
   
   filters: {
     status: 'all',
     searchQuery: '',
     lowBatteryOnly: false,
-    timeRange: TimeRange.LAST_HOUR
+    timeRange: TimeRange.LAST_HOUR,
+    sortBy: SortField.NONE,
+    sortDirection: 'asc'
   },
   
   connectionStatus: {
     connected: false,
     reconnecting: false,
     lastUpdate: Date.now(),
-    stale: true
+    stale: true,
+    shedding: false,
+    lagMs: 0
   },
 
-  updateVehicle: (vehicleId: string, data: VehicleData) => {
+  viewport: null,
+  clusterSummaries: [],
+  selectedVehicleId: null,
+  pinnedVehicleIds: new Set(),
+  replayActive: false,
+  hydratedAt: null,
+  alerts: [],
+
+  updateVehicle: (vehicleId: string, data: VehicleUpdate) => {
+    const changed: VehicleData[] = [];
     set((state) => {
-      const vehicles = new Map(state.vehicles);
-      const existing = vehicles.get(vehicleId);
-      
-      vehicles.set(vehicleId, {
-        ...existing,
-        ...data,
-        lastUpdate: Date.now()
-      });
-      
-      return { vehicles };
+      const counts = copyCounts(state.counts);
+      const countsChanged = writeVehicle(state.vehicles, counts, state.filters, vehicleId, data, Date.now(), changed);
+      return {
+        vehiclesVersion: state.vehicles.version,
+        ...(countsChanged && { counts })
+      };
     });
+    emitVehicleDelta({ changed, cleared: false, removed: [] });
   },
 
-  updateVehicles: (updates: Map<string, VehicleData>) => {
+  updateVehicles: (updates: Map<string, VehicleUpdate>) => {
+    const changed: VehicleData[] = [];
+    // Table, indexes and subscriber notification; delta consumers are timed on their own
+    const start = perfStart();
     set((state) => {
-      const vehicles = new Map(state.vehicles);
       const now = Date.now();
+      const counts = copyCounts(state.counts);
+      let countsChanged = false;
       
       updates.forEach((data, vehicleId) => {
-        const existing = vehicles.get(vehicleId);
-        vehicles.set(vehicleId, {
-          ...existing,
-          ...data,
-          lastUpdate: now
-        });
+        if (writeVehicle(state.vehicles, counts, state.filters, vehicleId, data, now, changed)) {
+          countsChanged = true;
+        }
       });
       
-      return { vehicles };
+      return {
+        vehiclesVersion: state.vehicles.version,
+        ...(countsChanged && { counts })
+      };
     });
+    perfMeasure(PerfHistogram.STORE_UPDATE, start);
+    emitVehicleDelta({ changed, cleared: false, removed: [] });
   },
 
   setFilter: (key, value) => {
+    const previous = get().filters;
     set((state) => ({
       filters: {
         ...state.filters,
         [key]: value
       }
     }));
+
+    // Re-rank only when the order or the set being ordered changed
+    const { filters, vehicles } = get();
+    if (
+      filters.sortBy !== previous.sortBy ||
+      filters.sortDirection !== previous.sortDirection ||
+      (sortIndex.active && !sameFilterCriteria(filters, previous))
+    ) {
+      sortIndex.configure(filters.sortBy, filters.sortDirection, filterIndex.query(filters, vehicles));
+    }
   },
 
   setConnectionStatus: (status: ConnectionStatus) => {
     set({ connectionStatus: status });
   },
 
+  setViewport: (viewport: ViewportBounds) => {
+    set({ viewport });
+  },
+
+  setClusterSummaries: (summaries: ClusterSummary[]) => {
+    set({ clusterSummaries: summaries });
+  },
+
+  selectVehicle: (vehicleId: string | null) => {
+    set({ selectedVehicleId: vehicleId });
+  },
+
+  togglePinnedVehicle: (vehicleId: string) => {
+    set((state) => {
+      const pinnedVehicleIds = new Set(state.pinnedVehicleIds);
+      if (!pinnedVehicleIds.delete(vehicleId)) pinnedVehicleIds.add(vehicleId);
+      return { pinnedVehicleIds };
+    });
+  },
+
+  setReplayActive: (active: boolean) => {
+    set({ replayActive: active });
+  },
+
+  hydrate: (vehicles: VehicleData[], filters: FilterState, viewport: ViewportBounds | null) => {
+    const changed: VehicleData[] = [];
+    set((state) => {
+      const counts = copyCounts(state.counts);
+      vehicles.forEach(vehicle => {
+        writeVehicle(state.vehicles, counts, filters, vehicle.id, vehicle, vehicle.lastUpdate, changed);
+      });
+      return {
+        filters,
+        viewport,
+        hydratedAt: Date.now(),
+        vehiclesVersion: state.vehicles.version,
+        counts
+      };
+    });
+    sortIndex.configure(filters.sortBy, filters.sortDirection, filterIndex.query(filters, get().vehicles));
+    emitVehicleDelta({ changed, cleared: false, removed: [] });
+  },
+
   clearVehicles: () => {
-    set({ vehicles: new Map() });
+    filterIndex.clear();
+    sortIndex.clear();
+    set((state) => {
+      state.vehicles.clear();
+      return {
+        vehiclesVersion: state.vehicles.version,
+        counts: createCounts(),
+        fleetCounts: null,
+        selectedVehicleId: null,
+        hydratedAt: null
+      };
+    });
+    emitVehicleDelta({ changed: [], cleared: true, removed: [] });
   },
 
-  getFilteredVehicles: () => {
-    const { vehicles, filters } = get();
-    let filtered = Array.from(vehicles.values());
+  removeVehicles: (vehicleIds: Iterable<string>) => {
+    const removed: VehicleData[] = [];
+    set((state) => {
+      const counts = copyCounts(state.counts);
+      for (const vehicleId of vehicleIds) {
+        const vehicle = state.vehicles.get(vehicleId);
+        if (!vehicle) continue;
+        filterIndex.remove(vehicle);
+        if (sortIndex.active) sortIndex.upsert(vehicle, false);
+        addToCounts(counts, vehicle, -1);
+        // A columnar view is invalid once its vehicle is deleted
+        removed.push(vehicle instanceof VehicleView ? vehicle.toJSON() : vehicle);
+        state.vehicles.delete(vehicleId);
+      }
+      return removed.length > 0 ? { vehiclesVersion: state.vehicles.version, counts } : {};
+    });
+    if (removed.length > 0) emitVehicleDelta({ changed: [], cleared: false, removed });
+  },
 
-    // Filter by status
-    if (filters.status !== 'all') {
-      filtered = filtered.filter(v => v.status === filters.status);
-    }
+  setFleetCounts: (counts: FleetCounts | null) => {
+    set({ fleetCounts: counts });
+  },
 
-    // Filter by low battery
-    if (filters.lowBatteryOnly) {
-      filtered = filtered.filter(v => v.battery < 20);
-    }
+  pushAlerts: (alerts: FleetAlert[]) => {
+    set((state) => ({
+      alerts: [...alerts.slice(-MAX_ALERTS).reverse(), ...state.alerts].slice(0, MAX_ALERTS)
+    }));
+  },
 
-    // Filter by search query
-    if (filters.searchQuery) {
-      const query = filters.searchQuery.toLowerCase();
-      filtered = filtered.filter(v => 
-        v.id.toLowerCase().includes(query)
-      );
-    }
+  dismissAlert: (alertId: string) => {
+    set((state) => ({ alerts: state.alerts.filter(alert => alert.id !== alertId) }));
+  },
 
-    return filtered;
+  clearAlerts: () => {
+    set({ alerts: [] });
+  },
+
+  getFilteredVehicles: () => {
+    const { vehicles, filters } = get();
+    return filterIndex.query(filters, vehicles);
   },
 
   getVehicleById: (id: string) => {
     return get().vehicles.get(id);
   },
 
+  getVehicleAt: (index: number) => {
+    const { vehicles, filters } = get();
+    if (!sortIndex.active) return filterIndex.query(filters, vehicles)[index];
+    const id = sortIndex.idAt(index);
+    return id === undefined ? undefined : vehicles.get(id);
+  },
+
+  getVehicleSlice: (start: number, end: number) => {
+    const { vehicles, filters } = get();
+    if (!sortIndex.active) return filterIndex.query(filters, vehicles).slice(start, end);
+    const result: VehicleData[] = [];
+    sortIndex.slice(start, end).forEach(id => {
+      const vehicle = vehicles.get(id);
+      if (vehicle) result.push(vehicle);
+    });
+    return result;
+  },
+
   getVehiclesByStatus: (status: VehicleStatus) => {
-    const vehicles = Array.from(get().vehicles.values());
-    return vehicles.filter(v => v.status === status);
+    const { vehicles } = get();
+    const result: VehicleData[] = [];
+    filterIndex.getStatusIds(status).forEach(id => {
+      const vehicle = vehicles.get(id);
+      if (vehicle) result.push(vehicle);
+    });
+    return result;
   },
 
   getOnlineCount: () => {
-    const vehicles = Array.from(get().vehicles.values());
-    return vehicles.filter(v => 
-      v.status === VehicleStatus.ONLINE || v.status === VehicleStatus.MOVING
-    ).length;
+    return fleetCountsOf(get()).online;
   },
 
   getLowBatteryCount: () => {
-    const vehicles = Array.from(get().vehicles.values());
-    return vehicles.filter(v => v.battery < 20).length;
+    return fleetCountsOf(get()).lowBattery;
   }
 }));
+
+// Counters for the whole fleet, even when this tab only holds the vehicles its filters select
+export const fleetCountsOf = (state: Pick<FleetStore, 'counts' | 'fleetCounts'>): FleetCounts =>
+  state.fleetCounts ?? state.counts;
+
+// Restored from a warm-start snapshot and not yet refreshed by a live update
+export const isUnconfirmed = (vehicle: VehicleData): boolean => {
+  const { hydratedAt } = useFleetStore.getState();
+  return hydratedAt !== null && vehicle.lastUpdate < hydratedAt;
+};
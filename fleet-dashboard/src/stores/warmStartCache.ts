@@ -0,0 +1,204 @@
+import { FilterState, VehicleData, VehicleStatus, ViewportBounds } from '../types';
+import { encodeStatus, decodeStatus } from '../utils/telemetryCodec';
+import { VehicleTable } from '../utils/vehicleTable';
+import { useFleetStore } from './fleetStore';
+
+const DB_NAME = 'fleet-dashboard';
+const DB_VERSION = 1;
+const STORE_NAME = 'warm-start';
+const SNAPSHOT_KEY = 'fleet';
+// Bumped whenever the snapshot layout changes; older snapshots are ignored
+const SNAPSHOT_FORMAT = 1;
+
+// Minimum time between background saves while the fleet keeps changing
+const SAVE_INTERVAL_MS = 30_000;
+// Snapshots older than this describe a fleet too different to be worth showing
+const MAX_SNAPSHOT_AGE_MS = 24 * 60 * 60 * 1000;
+
+/**
+ * Column-per-field copy of the vehicle table. Typed arrays are stored by
+ * IndexedDB as raw buffers, so a 50k-vehicle snapshot is about 2 MB and
+ * clones without per-vehicle objects. Sequence numbers are left out: they
+ * are only meaningful within the stream session that produced them.
+ */
+export interface FleetSnapshot {
+  format: number;
+  savedAt: number;
+  ids: string[];
+  latitude: Float64Array;
+  longitude: Float64Array;
+  speed: Float32Array;
+  battery: Uint8Array;
+  status: Uint8Array;
+  timestamp: Float64Array; // epoch ms, NaN when unknown
+  lastUpdate: Float64Array;
+  filters: FilterState;
+  viewport: ViewportBounds | null;
+}
+
+// Reads each vehicle's fields straight into the columns; columnar views are
+// read through their getters and never cloned themselves
+export const encodeFleetSnapshot = (
+  vehicles: VehicleTable,
+  filters: FilterState,
+  viewport: ViewportBounds | null,
+  now: number = Date.now()
+): FleetSnapshot => {
+  const count = vehicles.size;
+  const snapshot: FleetSnapshot = {
+    format: SNAPSHOT_FORMAT,
+    savedAt: now,
+    ids: new Array(count),
+    latitude: new Float64Array(count),
+    longitude: new Float64Array(count),
+    speed: new Float32Array(count),
+    battery: new Uint8Array(count),
+    status: new Uint8Array(count),
+    timestamp: new Float64Array(count),
+    lastUpdate: new Float64Array(count),
+    filters: { ...filters },
+    viewport: viewport && { ...viewport }
+  };
+
+  let i = 0;
+  vehicles.forEach((vehicle) => {
+    snapshot.ids[i] = vehicle.id;
+    snapshot.latitude[i] = vehicle.latitude;
+    snapshot.longitude[i] = vehicle.longitude;
+    snapshot.speed[i] = vehicle.speed;
+    snapshot.battery[i] = Math.round(vehicle.battery);
+    snapshot.status[i] = encodeStatus(vehicle.status);
+    snapshot.timestamp[i] = vehicle.timestamp ? Date.parse(vehicle.timestamp) : NaN;
+    snapshot.lastUpdate[i] = vehicle.lastUpdate;
+    i++;
+  });
+  return snapshot;
+};
+
+export const decodeFleetSnapshot = (snapshot: FleetSnapshot): VehicleData[] =>
+  snapshot.ids.map((id, i) => ({
+    id,
+    latitude: snapshot.latitude[i],
+    longitude: snapshot.longitude[i],
+    speed: snapshot.speed[i],
+    battery: snapshot.battery[i],
+    status: decodeStatus(snapshot.status[i]) ?? VehicleStatus.OFFLINE,
+    timestamp: Number.isNaN(snapshot.timestamp[i]) ? '' : new Date(snapshot.timestamp[i]).toISOString(),
+    lastUpdate: snapshot.lastUpdate[i]
+  }));
+
+const openDatabase = (): Promise<IDBDatabase> =>
+  new Promise((resolve, reject) => {
+    const request = indexedDB.open(DB_NAME, DB_VERSION);
+    request.onupgradeneeded = () => request.result.createObjectStore(STORE_NAME);
+    request.onsuccess = () => resolve(request.result);
+    request.onerror = () => reject(request.error);
+  });
+
+/**
+ * Persists the fleet table, filters and viewport to IndexedDB so a reload can
+ * paint the last known fleet before the socket delivers anything. Saves are
+ * throttled while updates stream in and forced when the page is hidden, which
+ * is the last moment a write is reliably allowed to finish.
+ */
+export class WarmStartCache {
+  private database: Promise<IDBDatabase> | null = null;
+  private saveTimer: ReturnType<typeof setTimeout> | null = null;
+  private savedVersion: number = -1;
+  private unsubscribe: (() => void) | null = null;
+
+  private open(): Promise<IDBDatabase> {
+    if (!this.database) {
+      this.database = openDatabase();
+      this.database.catch(() => {
+        this.database = null;
+      });
+    }
+    return this.database;
+  }
+
+  public async load(): Promise<FleetSnapshot | null> {
+    const database = await this.open();
+    const snapshot = await new Promise<FleetSnapshot | undefined>((resolve, reject) => {
+      const request = database.transaction(STORE_NAME, 'readonly').objectStore(STORE_NAME).get(SNAPSHOT_KEY);
+      request.onsuccess = () => resolve(request.result);
+      request.onerror = () => reject(request.error);
+    });
+    if (!snapshot || snapshot.format !== SNAPSHOT_FORMAT) return null;
+    if (Date.now() - snapshot.savedAt > MAX_SNAPSHOT_AGE_MS) return null;
+    return snapshot;
+  }
+
+  public async save(snapshot: FleetSnapshot): Promise<void> {
+    const database = await this.open();
+    await new Promise<void>((resolve, reject) => {
+      const transaction = database.transaction(STORE_NAME, 'readwrite');
+      transaction.objectStore(STORE_NAME).put(snapshot, SNAPSHOT_KEY);
+      transaction.oncomplete = () => resolve();
+      transaction.onerror = () => reject(transaction.error);
+    });
+  }
+
+  // Seeds the store from the saved snapshot if it arrives within `maxWaitMs`;
+  // a snapshot that loads later is discarded so it cannot overwrite live data.
+  // Resolves to whether the store was hydrated.
+  public restore(maxWaitMs: number): Promise<boolean> {
+    let expired = false;
+    const hydrate = this.load()
+      .then((snapshot) => {
+        const { vehicles, hydrate: hydrateStore } = useFleetStore.getState();
+        if (!snapshot || expired || vehicles.size > 0) return false;
+        hydrateStore(decodeFleetSnapshot(snapshot), snapshot.filters, snapshot.viewport);
+        return true;
+      })
+      .catch((error) => {
+        console.error('Failed to load warm-start snapshot:', error);
+        return false;
+      });
+    const timeout = new Promise<boolean>(resolve => setTimeout(() => {
+      expired = true;
+      resolve(false);
+    }, maxWaitMs));
+    return Promise.race([hydrate, timeout]);
+  }
+
+  // Starts saving the store on its own schedule; call once after `restore`
+  public start(): void {
+    this.stop();
+    this.savedVersion = useFleetStore.getState().vehiclesVersion;
+    const unsubscribeStore = useFleetStore.subscribe((state) => {
+      if (this.saveTimer === null && state.vehiclesVersion !== this.savedVersion) {
+        this.saveTimer = setTimeout(() => this.flush(), SAVE_INTERVAL_MS);
+      }
+    });
+    const onVisibilityChange = () => {
+      if (document.visibilityState === 'hidden') this.flush();
+    };
+    document.addEventListener('visibilitychange', onVisibilityChange);
+    this.unsubscribe = () => {
+      unsubscribeStore();
+      document.removeEventListener('visibilitychange', onVisibilityChange);
+    };
+  }
+
+  public stop(): void {
+    this.unsubscribe?.();
+    this.unsubscribe = null;
+    if (this.saveTimer !== null) clearTimeout(this.saveTimer);
+    this.saveTimer = null;
+  }
+
+  // Writes the current fleet now unless nothing changed since the last save.
+  // Replayed history is never persisted.
+  public flush(): void {
+    if (this.saveTimer !== null) clearTimeout(this.saveTimer);
+    this.saveTimer = null;
+
+    const { vehicles, vehiclesVersion, filters, viewport, replayActive } = useFleetStore.getState();
+    if (replayActive || vehiclesVersion === this.savedVersion || vehicles.size === 0) return;
+    this.savedVersion = vehiclesVersion;
+    this.save(encodeFleetSnapshot(vehicles, filters, viewport)).catch((error) => {
+      console.error('Failed to save warm-start snapshot:', error);
+    });
+  }
+}
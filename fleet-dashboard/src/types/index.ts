@@ -10,8 +10,12 @@ export interface VehicleData {
   timestamp: string; // ISO 8601
   status: VehicleStatus;
   lastUpdate: number; // Unix timestamp ms
+  seq?: number; // Per-vehicle sequence number of the last applied update
 }
 
+// Update merged into the stored vehicle; fields left out keep their previous value
+export type VehicleUpdate = Partial<VehicleData> & Pick<VehicleData, 'id'>;
+
 export enum VehicleStatus {
   ONLINE = 'online',
   MOVING = 'moving',
@@ -21,11 +25,82 @@ export enum VehicleStatus {
 }
 
 export interface WebSocketMessage {
-  type: 'vehicle_update' | 'batch_update' | 'error' | 'connection';
-  data: VehicleData | VehicleData[] | ErrorData | ConnectionData;
+  type:
+    | 'vehicle_update'
+    | 'batch_update'
+    | 'vehicle_patch'
+    | 'cluster_summary'
+    | 'checkpoint'
+    | 'catch_up'
+    | 'error'
+    | 'connection';
+  data:
+    | VehicleData
+    | VehicleData[]
+    | VehiclePatch
+    | VehiclePatch[]
+    | ClusterSummary[]
+    | StreamCheckpoint
+    | CatchUpData
+    | ErrorData
+    | ConnectionData;
   timestamp: string;
 }
 
+// Field-presence bits of VehiclePatch.mask
+export enum PatchField {
+  SPEED = 1 << 0,
+  BATTERY = 1 << 1,
+  LATITUDE = 1 << 2,
+  LONGITUDE = 1 << 3,
+  ALTITUDE = 1 << 4,
+  SATELLITES = 1 << 5,
+  TIMESTAMP = 1 << 6,
+  STATUS = 1 << 7
+}
+
+// Changed fields of one vehicle; only the fields flagged in `mask` are meaningful
+export interface VehiclePatch extends Partial<Omit<VehicleData, 'id' | 'seq' | 'lastUpdate'>> {
+  id: string;
+  seq: number;
+  mask: number;
+}
+
+export interface GeoBounds {
+  south: number;
+  west: number;
+  north: number;
+  east: number;
+}
+
+// Visible map area sent with the socket `subscribe` message
+export interface ViewportBounds extends GeoBounds {
+  zoom: number;
+}
+
+// Server-side aggregate standing in for the vehicles of one region at low zoom
+export interface ClusterSummary {
+  id: string;
+  latitude: number;
+  longitude: number;
+  count: number;
+  byStatus?: Partial<Record<VehicleStatus, number>>;
+}
+
+// Position in the server's stream; `epoch` changes whenever the server loses stream history
+export interface StreamCheckpoint {
+  epoch: string;
+  seq: number;
+}
+
+// Server reply to `resume`: the missed changes, or the whole fleet when they are no longer available
+export interface CatchUpData {
+  mode: 'delta' | 'snapshot';
+  checkpoint: StreamCheckpoint;
+  vehicles?: VehicleData[];
+  patches?: VehiclePatch[];
+}
+
 export interface ErrorData {
   code: string;
   message: string;
@@ -54,8 +129,20 @@ export interface FilterState {
   searchQuery: string;
   lowBatteryOnly: boolean;
   timeRange: TimeRange;
+  sortBy: SortField;
+  sortDirection: SortDirection;
+}
+
+// List ordering; NONE keeps arrival order
+export enum SortField {
+  NONE = 'none',
+  BATTERY = 'battery',
+  SPEED = 'speed',
+  LAST_UPDATE = 'last_update'
 }
 
+export type SortDirection = 'asc' | 'desc';
+
 export enum TimeRange {
   LAST_HOUR = 'last_hour',
   LAST_24H = 'last_24h',
@@ -63,9 +150,59 @@ export enum TimeRange {
   CUSTOM = 'custom'
 }
 
+export interface FleetCounts {
+  total: number;
+  online: number; // online + moving
+  lowBattery: number;
+  byStatus: Record<VehicleStatus, number>;
+}
+
 export interface ConnectionStatus {
   connected: boolean;
   reconnecting: boolean;
   lastUpdate: number;
   stale: boolean; // No updates received for >10s
+  shedding: boolean; // Behind the stream: updates the user cannot see are delayed
+  lagMs: number; // Ingest lag above the clock-offset baseline
+}
+
+// What the user is looking at; while shedding, updates outside it are delayed
+export interface IngestFocus {
+  bounds: GeoBounds | null;
+  // The map draws the vehicles inside `bounds` as clusters at its current zoom
+  clustered: boolean;
+  // Selected and pinned vehicles, never delayed
+  vehicleIds: string[];
+}
+
+// Named polygon alert rules can target by tag, e.g. 'depot' or 'school_zone'
+export interface Geofence {
+  id: string;
+  name: string;
+  tags: string[];
+  // Outer ring as [latitude, longitude] pairs; the closing vertex may be omitted
+  polygon: Array<[number, number]>;
+}
+
+export enum AlertType {
+  ENTER = 'enter',
+  EXIT = 'exit',
+  SPEED_IN_ZONE = 'speed_in_zone',
+  STALE = 'stale'
+}
+
+// Geofence rules apply to every fence carrying `tag`; alerts fire on transitions only
+export type AlertRule =
+  | { id: string; type: AlertType.ENTER | AlertType.EXIT; tag: string }
+  | { id: string; type: AlertType.SPEED_IN_ZONE; tag: string; maxSpeed: number } // km/h
+  | { id: string; type: AlertType.STALE; afterMs: number };
+
+export interface FleetAlert {
+  id: string;
+  ruleId: string;
+  type: AlertType;
+  vehicleId: string;
+  geofenceId?: string;
+  message: string;
+  time: number; // Unix timestamp ms
 }
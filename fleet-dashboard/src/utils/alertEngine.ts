@@ -0,0 +1,227 @@
+import { AlertRule, AlertType, FleetAlert, Geofence, VehicleData, VehicleStatus } from '../types';
+import { GeofenceIndex } from './geofenceIndex';
+import { TimerWheel } from './timerWheel';
+
+type SpeedRule = Extract<AlertRule, { type: AlertType.SPEED_IN_ZONE }>;
+type StaleRule = Extract<AlertRule, { type: AlertType.STALE }>;
+
+// Rules of each kind that apply to one geofence, resolved once per load
+interface FenceRules {
+  enter: AlertRule[];
+  exit: AlertRule[];
+  speed: SpeedRule[];
+}
+
+interface VehicleState {
+  latitude: number;
+  longitude: number;
+  speed: number;
+  // Sorted indexes of the fences the vehicle was last seen inside
+  inside: number[];
+  // `${ruleId}:${fenceIndex}` for every speed rule currently violated
+  speeding: Set<string> | null;
+}
+
+const formatDuration = (ms: number): string =>
+  ms % 60_000 === 0 ? `${ms / 60_000} min` : `${Math.round(ms / 1000)} s`;
+
+const sameFences = (a: number[], b: number[]): boolean => {
+  if (a.length !== b.length) return false;
+  for (let i = 0; i < a.length; i++) {
+    if (a[i] !== b[i]) return false;
+  }
+  return true;
+};
+
+type AlertHandler = (alerts: FleetAlert[]) => void;
+
+/**
+ * Evaluates alert rules against store deltas. Only the vehicles in a delta
+ * are looked at, and a vehicle whose position and speed did not change skips
+ * the geofence lookup entirely; the lookup itself goes through a grid over
+ * fence bounding boxes. Geofence alerts fire on transitions — entering,
+ * leaving, or starting to speed inside a zone — never while a condition
+ * merely holds. Staleness comes from a timer per vehicle on a timer wheel,
+ * re-armed from `lastUpdate` on every update, so no periodic fleet scan runs.
+ */
+export class AlertEngine {
+  private index = new GeofenceIndex();
+  private fenceRules: FenceRules[] = [];
+  private staleRule: StaleRule | null = null;
+  private vehicles: Map<string, VehicleState> = new Map();
+  private wheel = new TimerWheel();
+  // Vehicles known before this time are timed from here instead of their lastUpdate
+  private watchingSince: number;
+  private handlers: Set<AlertHandler> = new Set();
+  private pending: FleetAlert[] = [];
+  private nextId: number = 0;
+  private scratch: number[] = [];
+
+  constructor(rules: AlertRule[] = [], geofences: Geofence[] = [], now: number = Date.now()) {
+    this.watchingSince = now;
+    this.configure(rules, geofences);
+  }
+
+  public get geofenceCount(): number {
+    return this.index.size;
+  }
+
+  public onAlert(handler: AlertHandler): () => void {
+    this.handlers.add(handler);
+    return () => this.handlers.delete(handler);
+  }
+
+  // Replaces rules and fences. Known vehicles are placed in the new fences
+  // without firing, so a reload does not replay enter/exit alerts.
+  public configure(rules: AlertRule[], geofences: Geofence[]): void {
+    this.index.load(geofences);
+    this.fenceRules = [];
+    for (let i = 0; i < this.index.size; i++) {
+      const { tags } = this.index.get(i).fence;
+      const matching = rules.filter(rule => rule.type !== AlertType.STALE && tags.includes(rule.tag));
+      this.fenceRules.push({
+        enter: matching.filter(rule => rule.type === AlertType.ENTER),
+        exit: matching.filter(rule => rule.type === AlertType.EXIT),
+        speed: matching.filter((rule): rule is SpeedRule => rule.type === AlertType.SPEED_IN_ZONE)
+      });
+    }
+    this.staleRule = rules.find((rule): rule is StaleRule => rule.type === AlertType.STALE) ?? null;
+    if (!this.staleRule) this.wheel.clear();
+    this.vehicles.forEach((state, vehicleId) => this.evaluateFences(vehicleId, state, false));
+  }
+
+  public apply(changed: Iterable<VehicleData>): void {
+    for (const vehicle of changed) {
+      const state = this.vehicles.get(vehicle.id);
+      if (!state) {
+        const added: VehicleState = {
+          latitude: vehicle.latitude,
+          longitude: vehicle.longitude,
+          speed: vehicle.speed,
+          inside: [],
+          speeding: null
+        };
+        this.vehicles.set(vehicle.id, added);
+        // The first position only establishes where the vehicle is
+        this.evaluateFences(vehicle.id, added, false);
+      } else if (
+        vehicle.latitude !== state.latitude || vehicle.longitude !== state.longitude || vehicle.speed !== state.speed
+      ) {
+        state.latitude = vehicle.latitude;
+        state.longitude = vehicle.longitude;
+        state.speed = vehicle.speed;
+        this.evaluateFences(vehicle.id, state, true);
+      }
+      this.scheduleStale(vehicle);
+    }
+    this.emit();
+  }
+
+  // Vehicles no longer streamed to this engine, e.g. outside a shared-mode tab's filter;
+  // they are not stale, so their timers go too
+  public remove(vehicleIds: Iterable<string>): void {
+    for (const vehicleId of vehicleIds) {
+      this.vehicles.delete(vehicleId);
+      this.wheel.cancel(vehicleId);
+    }
+  }
+
+  // Fires staleness alerts that have come due; cheap enough to call every second
+  public tick(now: number = Date.now()): void {
+    const rule = this.staleRule;
+    if (!rule) return;
+    this.wheel.advance(now, (vehicleId) => {
+      if (!this.vehicles.has(vehicleId)) return;
+      this.push(rule, vehicleId, undefined, `No update from ${vehicleId} for ${formatDuration(rule.afterMs)}`, now);
+    });
+    this.emit();
+  }
+
+  public clear(now: number = Date.now()): void {
+    this.vehicles.clear();
+    this.wheel.clear();
+    this.pending = [];
+    this.watchingSince = now;
+  }
+
+  private evaluateFences(vehicleId: string, state: VehicleState, fire: boolean): void {
+    const inside = this.scratch;
+    inside.length = 0;
+    this.index.query(state.latitude, state.longitude, inside);
+    if (inside.length > 1) inside.sort((a, b) => a - b);
+
+    if (fire) {
+      // Both lists are sorted: one merge pass finds entries and exits
+      const previous = state.inside;
+      let i = 0;
+      let j = 0;
+      while (i < previous.length || j < inside.length) {
+        if (j >= inside.length || (i < previous.length && previous[i] < inside[j])) {
+          this.fenceTransition(this.fenceRules[previous[i]].exit, vehicleId, previous[i], 'left');
+          i++;
+        } else if (i >= previous.length || inside[j] < previous[i]) {
+          this.fenceTransition(this.fenceRules[inside[j]].enter, vehicleId, inside[j], 'entered');
+          j++;
+        } else {
+          i++;
+          j++;
+        }
+      }
+    }
+    if (!sameFences(inside, state.inside)) state.inside = inside.slice();
+    if (state.inside.length > 0 || state.speeding) this.evaluateSpeed(vehicleId, state, fire);
+  }
+
+  private evaluateSpeed(vehicleId: string, state: VehicleState, fire: boolean): void {
+    let speeding: Set<string> | null = null;
+    state.inside.forEach((fenceIndex) => {
+      this.fenceRules[fenceIndex].speed.forEach((rule) => {
+        if (state.speed <= rule.maxSpeed) return;
+        const key = `${rule.id}:${fenceIndex}`;
+        (speeding ??= new Set()).add(key);
+        if (fire && !state.speeding?.has(key)) {
+          const { fence } = this.index.get(fenceIndex);
+          this.push(rule, vehicleId, fence.id,
+            `${vehicleId} at ${Math.round(state.speed)} km/h in ${fence.name} (limit ${rule.maxSpeed})`,
+            Date.now());
+        }
+      });
+    });
+    state.speeding = speeding;
+  }
+
+  private fenceTransition(rules: AlertRule[], vehicleId: string, fenceIndex: number, verb: string): void {
+    if (rules.length === 0) return;
+    const { fence } = this.index.get(fenceIndex);
+    const now = Date.now();
+    rules.forEach(rule => this.push(rule, vehicleId, fence.id, `${vehicleId} ${verb} ${fence.name}`, now));
+  }
+
+  // Offline vehicles are not expected to report and are not timed
+  private scheduleStale(vehicle: VehicleData): void {
+    if (!this.staleRule || vehicle.status === VehicleStatus.OFFLINE) {
+      this.wheel.cancel(vehicle.id);
+      return;
+    }
+    this.wheel.schedule(vehicle.id, Math.max(vehicle.lastUpdate, this.watchingSince) + this.staleRule.afterMs);
+  }
+
+  private push(rule: AlertRule, vehicleId: string, geofenceId: string | undefined, message: string, time: number): void {
+    this.pending.push({
+      id: `${time}-${++this.nextId}`,
+      ruleId: rule.id,
+      type: rule.type,
+      vehicleId,
+      ...(geofenceId !== undefined && { geofenceId }),
+      message,
+      time
+    });
+  }
+
+  private emit(): void {
+    if (this.pending.length === 0) return;
+    const alerts = this.pending;
+    this.pending = [];
+    this.handlers.forEach(handler => handler(alerts));
+  }
+}
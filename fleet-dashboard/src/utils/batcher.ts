@@ -1,51 +1,269 @@
-import { VehicleData } from '../types';
+import { VehicleUpdate, VehiclePatch } from '../types';
+import { patchToUpdate } from './vehiclePatch';
+import { PerfCounter, PerfHistogram, perfCount, perfRecord } from './perfMetrics';
+
+// Minimum time before the same vehicle is asked for again while its resync is outstanding
+const RESYNC_RETRY_MS = 5000;
+// Sequence of a vehicle whose base snapshot carried no seq; its next patch is taken as is
+const UNSEQUENCED = -Infinity;
+
+const FRAME_MS = 1000 / 60;
+const DEFAULT_FRAME_BUDGET_MS = 8;
+const DEFAULT_HIDDEN_FLUSH_INTERVAL_MS = 1000;
+// Well under the stale-vehicle alert threshold, so a background tab does not report its fleet as silent
+const DEFAULT_HIDDEN_COMMIT_INTERVAL_MS = 30000;
+
+// 'timeout' flushes every flushInterval ms; 'frame' aligns flushes to requestAnimationFrame
+export type FlushSchedule = 'timeout' | 'frame';
+
+export interface BatcherOptions {
+  // Called once per flush with vehicles whose patch stream has a gap or no base snapshot
+  onResync?: (vehicleIds: string[]) => void;
+  schedule?: FlushSchedule;
+  // Commit time a frame-aligned flush may take before the batcher skips frames
+  frameBudgetMs?: number;
+  // Tick period while the document is hidden (frames do not fire in background tabs);
+  // ticks only coalesce and request resyncs
+  hiddenFlushInterval?: number;
+  // While hidden, coalesced updates are committed only this often, and on becoming visible
+  hiddenCommitInterval?: number;
+  // Commit time is reported through reportCommitTime() instead of timing the callback,
+  // for when the callback only hands the batch to another thread
+  externalCommitTiming?: boolean;
+}
+
+const requestFrame = (callback: () => void): (() => void) => {
+  if (typeof requestAnimationFrame === 'function') {
+    const handle = requestAnimationFrame(callback);
+    return () => cancelAnimationFrame(handle);
+  }
+  const handle = setTimeout(callback, FRAME_MS);
+  return () => clearTimeout(handle);
+};
 
 export class VehicleUpdateBatcher {
-  private pendingUpdates: Map<string, VehicleData> = new Map();
-  private flushTimer: number | null = null;
+  private pendingUpdates: Map<string, VehicleUpdate> = new Map();
+  private lastSeq: Map<string, number> = new Map();
+  private pendingResync: Set<string> = new Set();
+  private resyncRequestedAt: Map<string, number> = new Map();
+  private cancelScheduled: (() => void) | null = null;
+  // When the oldest pending update was queued
+  private pendingSince: number = 0;
+  private lastCommit: number = 0;
   private flushInterval: number;
-  private flushCallback: (updates: Map<string, VehicleData>) => void;
+  private flushCallback: (updates: Map<string, VehicleUpdate>) => void;
+  private options: BatcherOptions;
 
-  constructor(flushInterval: number, flushCallback: (updates: Map<string, VehicleData>) => void) {
+  // Frame scheduling state: flush every `framesPerFlush` frames, adapted to commit time
+  private framesPerFlush: number = 1;
+  private framesWaited: number = 0;
+  private hidden: boolean = false;
+  private visibilityListener: (() => void) | null = null;
+
+  constructor(
+    flushInterval: number,
+    flushCallback: (updates: Map<string, VehicleUpdate>) => void,
+    options: BatcherOptions = {}
+  ) {
     this.flushInterval = flushInterval;
     this.flushCallback = flushCallback;
-  }
-
-  public addUpdate(vehicleId: string, data: VehicleData): void {
-    this.pendingUpdates.set(vehicleId, data);
+    this.options = options;
 
-    if (!this.flushTimer) {
-      this.flushTimer = window.setTimeout(() => this.flush(), this.flushInterval);
+    if (options.schedule === 'frame' && typeof document !== 'undefined') {
+      this.hidden = document.hidden;
+      this.visibilityListener = () => this.setHidden(document.hidden);
+      document.addEventListener('visibilitychange', this.visibilityListener);
     }
   }
 
-  public addBatch(updates: VehicleData[]): void {
+  public addUpdate(vehicleId: string, data: VehicleUpdate): void {
+    this.acceptSnapshot(vehicleId, data);
+    this.scheduleFlush();
+  }
+
+  public addBatch(updates: VehicleUpdate[]): void {
     updates.forEach(update => {
-      this.pendingUpdates.set(update.id, update);
+      this.acceptSnapshot(update.id, update);
     });
+    this.scheduleFlush();
+  }
 
-    if (!this.flushTimer) {
-      this.flushTimer = window.setTimeout(() => this.flush(), this.flushInterval);
+  public addPatch(patch: VehiclePatch): void {
+    this.acceptPatch(patch);
+    this.scheduleFlush();
+  }
+
+  public addPatches(patches: VehiclePatch[]): void {
+    patches.forEach(patch => this.acceptPatch(patch));
+    this.scheduleFlush();
+  }
+
+  // Drops the sequence state of vehicles no longer in the table, or of every vehicle;
+  // their next patch waits for a fresh snapshot
+  public forget(vehicleIds?: Iterable<string>): void {
+    if (!vehicleIds) {
+      this.lastSeq.clear();
+      this.pendingResync.clear();
+      this.resyncRequestedAt.clear();
+      return;
+    }
+    for (const id of vehicleIds) {
+      this.lastSeq.delete(id);
+      this.pendingResync.delete(id);
+      this.resyncRequestedAt.delete(id);
     }
   }
 
   public flush(): void {
+    this.cancelScheduled?.();
+    this.cancelScheduled = null;
+    this.framesWaited = 0;
+
     if (this.pendingUpdates.size > 0) {
-      this.flushCallback(new Map(this.pendingUpdates));
+      const updates = new Map(this.pendingUpdates);
       this.pendingUpdates.clear();
+      perfCount(PerfCounter.UPDATES, updates.size);
+      perfRecord(PerfHistogram.BATCH_SIZE, updates.size);
+
+      const start = performance.now();
+      this.flushCallback(updates);
+      const end = performance.now();
+      this.lastCommit = end;
+      if (this.options.schedule === 'frame' && !this.options.externalCommitTiming) {
+        this.reportCommitTime(end - start);
+      }
+      perfRecord(PerfHistogram.FLUSH, end - start);
+      perfRecord(PerfHistogram.BATCH_WAIT, end - this.pendingSince);
     }
 
-    if (this.flushTimer) {
-      clearTimeout(this.flushTimer);
-      this.flushTimer = null;
+    this.sendResyncs();
+  }
+
+  // Backs off (skips more frames) when a commit overruns the frame budget, recovers when it fits
+  public reportCommitTime(durationMs: number): void {
+    const budget = this.options.frameBudgetMs ?? DEFAULT_FRAME_BUDGET_MS;
+    const maxFramesPerFlush = Math.max(1, Math.round(this.flushInterval / FRAME_MS));
+
+    if (durationMs > budget) {
+      this.framesPerFlush = Math.min(this.framesPerFlush * 2, maxFramesPerFlush);
+    } else if (durationMs < budget / 2 && this.framesPerFlush > 1) {
+      this.framesPerFlush--;
+    }
+  }
+
+  // While hidden, frame scheduling drops to a low-frequency tick that rarely commits;
+  // becoming visible flushes on the next frame
+  public setHidden(hidden: boolean): void {
+    if (this.hidden === hidden) return;
+    this.hidden = hidden;
+
+    if (this.cancelScheduled) {
+      this.cancelScheduled();
+      this.cancelScheduled = null;
+      this.framesWaited = hidden ? 0 : this.framesPerFlush;
+      this.scheduleFlush();
     }
   }
 
   public destroy(): void {
-    if (this.flushTimer) {
-      clearTimeout(this.flushTimer);
-      this.flushTimer = null;
+    this.cancelScheduled?.();
+    this.cancelScheduled = null;
+    if (this.visibilityListener) {
+      document.removeEventListener('visibilitychange', this.visibilityListener);
+      this.visibilityListener = null;
     }
     this.pendingUpdates.clear();
+    this.pendingResync.clear();
+    this.resyncRequestedAt.clear();
+    this.lastSeq.clear();
+  }
+
+  private scheduleFlush(): void {
+    if (this.cancelScheduled || (this.pendingUpdates.size === 0 && this.pendingResync.size === 0)) {
+      return;
+    }
+    this.pendingSince = performance.now();
+    this.scheduleNext();
+  }
+
+  private scheduleNext(): void {
+    if (this.options.schedule !== 'frame') {
+      const handle = setTimeout(() => this.flush(), this.flushInterval);
+      this.cancelScheduled = () => clearTimeout(handle);
+    } else if (this.hidden) {
+      const interval = this.options.hiddenFlushInterval ?? DEFAULT_HIDDEN_FLUSH_INTERVAL_MS;
+      const handle = setTimeout(() => this.onHiddenTick(), interval);
+      this.cancelScheduled = () => clearTimeout(handle);
+    } else {
+      this.cancelScheduled = requestFrame(() => this.onFrame());
+    }
+  }
+
+  // Nobody sees a hidden tab's table: updates keep coalescing per vehicle and are only
+  // committed every hiddenCommitInterval, while resyncs still go out every tick
+  private onHiddenTick(): void {
+    this.cancelScheduled = null;
+    const commitInterval = this.options.hiddenCommitInterval ?? DEFAULT_HIDDEN_COMMIT_INTERVAL_MS;
+    if (performance.now() - this.lastCommit >= commitInterval) {
+      this.flush();
+      return;
+    }
+    this.sendResyncs();
+    if (this.pendingUpdates.size > 0) this.scheduleNext();
+  }
+
+  private onFrame(): void {
+    this.cancelScheduled = null;
+    this.framesWaited++;
+    if (this.framesWaited >= this.framesPerFlush) {
+      this.flush();
+    } else {
+      this.cancelScheduled = requestFrame(() => this.onFrame());
+    }
+  }
+
+  private sendResyncs(): void {
+    if (this.pendingResync.size > 0) {
+      const now = Date.now();
+      const vehicleIds = Array.from(this.pendingResync).filter(id => {
+        const requestedAt = this.resyncRequestedAt.get(id);
+        return requestedAt === undefined || now - requestedAt >= RESYNC_RETRY_MS;
+      });
+      vehicleIds.forEach(id => this.resyncRequestedAt.set(id, now));
+      this.pendingResync.clear();
+      if (vehicleIds.length > 0) this.options.onResync?.(vehicleIds);
+    }
+  }
+
+  // Full snapshots replace anything pending and become the base for later patches;
+  // one without a seq restarts the vehicle's sequence at its next patch
+  private acceptSnapshot(vehicleId: string, data: VehicleUpdate): void {
+    if (data.seq !== undefined) {
+      const last = this.lastSeq.get(vehicleId);
+      if (last !== undefined && data.seq < last) return;
+    }
+    this.lastSeq.set(vehicleId, data.seq ?? UNSEQUENCED);
+    this.pendingResync.delete(vehicleId);
+    this.resyncRequestedAt.delete(vehicleId);
+    this.pendingUpdates.set(vehicleId, data);
+  }
+
+  // Drops duplicate and out-of-order patches; a gap still applies the patch but asks for a resync
+  private acceptPatch(patch: VehiclePatch): void {
+    const last = this.lastSeq.get(patch.id);
+
+    if (last === undefined) {
+      this.pendingResync.add(patch.id);
+      return;
+    }
+    if (patch.seq <= last) return;
+    if (last !== UNSEQUENCED && patch.seq > last + 1) {
+      this.pendingResync.add(patch.id);
+    }
+
+    this.lastSeq.set(patch.id, patch.seq);
+    const update = patchToUpdate(patch);
+    const pending = this.pendingUpdates.get(patch.id);
+    this.pendingUpdates.set(patch.id, pending ? { ...pending, ...update } : update);
   }
 }
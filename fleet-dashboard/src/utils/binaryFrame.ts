@@ -0,0 +1,119 @@
+import { VehicleData, VehicleStatus } from '../types';
+import { decodeStatus, VehicleIdDictionary } from './telemetryCodec';
+
+// WebSocket subprotocols offered by the client, preferred first
+export const BINARY_SUBPROTOCOL = 'fleet-telemetry.bin.v1';
+export const JSON_SUBPROTOCOL = 'fleet-telemetry.json.v1';
+
+export const FRAME_VERSION = 1;
+
+export enum FrameType {
+  BATCH_UPDATE = 1,
+  // Same layout; the full fleet as catch-up after a resume the server could not serve as a delta
+  SNAPSHOT = 2
+}
+
+// Quantization of the wire columns
+export const COORDINATE_SCALE = 1e7; // int32 degrees * 1e7 (~1 cm)
+export const SPEED_SCALE = 10; // uint16 km/h * 10
+
+const HEADER_BYTES = 16;
+const utf8 = new TextDecoder();
+
+/**
+ * Decoded `batch_update` frame. Layout (little-endian):
+ *
+ *   u8 version | u8 frame type | u16 dictionary entries | u32 record count | f64 base timestamp (ms)
+ *   dictionary: per entry u32 slot, u8 byte length, UTF-8 vehicle ID
+ *   columns, each record count long: u32 slot, i32 lat, i32 lon, u16 speed,
+ *   u8 battery, u8 status code, u32 timestamp delta (ms from base)
+ *
+ * The dictionary is per connection: entries are only sent the first time the
+ * server references a slot after the socket opens.
+ */
+export interface TelemetryFrame {
+  type: FrameType;
+  count: number;
+  baseTimestamp: number;
+  slots: Uint32Array;
+  latitude: Float64Array;
+  longitude: Float64Array;
+  speed: Float32Array;
+  battery: Uint8Array;
+  status: Uint8Array;
+  timestampDelta: Uint32Array;
+}
+
+export const decodeTelemetryFrame = (buffer: ArrayBuffer, dictionary: VehicleIdDictionary): TelemetryFrame => {
+  const view = new DataView(buffer);
+
+  const version = view.getUint8(0);
+  if (version !== FRAME_VERSION) {
+    throw new Error(`Unsupported telemetry frame version ${version}`);
+  }
+  const frameType = view.getUint8(1);
+  if (frameType !== FrameType.BATCH_UPDATE && frameType !== FrameType.SNAPSHOT) {
+    throw new Error(`Unsupported telemetry frame type ${frameType}`);
+  }
+
+  const dictionaryEntries = view.getUint16(2, true);
+  const count = view.getUint32(4, true);
+  const baseTimestamp = view.getFloat64(8, true);
+  let offset = HEADER_BYTES;
+
+  for (let i = 0; i < dictionaryEntries; i++) {
+    const slot = view.getUint32(offset, true);
+    const length = view.getUint8(offset + 4);
+    offset += 5;
+    dictionary.assign(slot, utf8.decode(new Uint8Array(buffer, offset, length)));
+    offset += length;
+  }
+
+  const frame: TelemetryFrame = {
+    type: frameType,
+    count,
+    baseTimestamp,
+    slots: new Uint32Array(count),
+    latitude: new Float64Array(count),
+    longitude: new Float64Array(count),
+    speed: new Float32Array(count),
+    battery: new Uint8Array(count),
+    status: new Uint8Array(count),
+    timestampDelta: new Uint32Array(count)
+  };
+
+  for (let i = 0; i < count; i++, offset += 4) frame.slots[i] = view.getUint32(offset, true);
+  for (let i = 0; i < count; i++, offset += 4) frame.latitude[i] = view.getInt32(offset, true) / COORDINATE_SCALE;
+  for (let i = 0; i < count; i++, offset += 4) frame.longitude[i] = view.getInt32(offset, true) / COORDINATE_SCALE;
+  for (let i = 0; i < count; i++, offset += 2) frame.speed[i] = view.getUint16(offset, true) / SPEED_SCALE;
+  frame.battery.set(new Uint8Array(buffer, offset, count));
+  offset += count;
+  frame.status.set(new Uint8Array(buffer, offset, count));
+  offset += count;
+  for (let i = 0; i < count; i++, offset += 4) frame.timestampDelta[i] = view.getUint32(offset, true);
+
+  return frame;
+};
+
+// Records whose slot has no dictionary entry on this connection are skipped
+export const frameToVehicles = (frame: TelemetryFrame, dictionary: VehicleIdDictionary): VehicleData[] => {
+  const vehicles: VehicleData[] = [];
+
+  for (let i = 0; i < frame.count; i++) {
+    const id = dictionary.idAt(frame.slots[i]);
+    if (id === undefined) continue;
+    const timestamp = frame.baseTimestamp + frame.timestampDelta[i];
+    vehicles.push({
+      id,
+      latitude: frame.latitude[i],
+      longitude: frame.longitude[i],
+      speed: frame.speed[i],
+      battery: frame.battery[i],
+      status: decodeStatus(frame.status[i]) ?? VehicleStatus.OFFLINE,
+      timestamp: new Date(timestamp).toISOString(),
+      lastUpdate: timestamp
+    });
+  }
+
+  return vehicles;
+};
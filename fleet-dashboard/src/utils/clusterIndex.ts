@@ -0,0 +1,218 @@
+import { GeoBounds, VehicleStatus } from '../types';
+import { STATUS_CODES, decodeStatus } from './telemetryCodec';
+import { projectToWorld, unprojectFromWorld } from './mercator';
+
+export const CLUSTER_MIN_ZOOM = 0;
+// Above this zoom every vehicle is returned as its own point
+export const CLUSTER_MAX_ZOOM = 16;
+// Cluster cell edge in screen pixels (256 px tiles)
+const CLUSTER_RADIUS_PX = 60;
+
+// One rendered map feature: a single vehicle or a cluster of several
+export interface ClusterFeature {
+  id: string; // vehicle ID for single vehicles, so their markers survive zoom changes
+  latitude: number;
+  longitude: number;
+  count: number;
+  vehicleId?: string; // set when count is 1
+  status?: VehicleStatus; // single vehicle's status, or the most common one in the cluster
+}
+
+interface ClusterCell {
+  count: number;
+  sumX: number;
+  sumY: number;
+  ids: Set<string>;
+  statusCounts: Uint32Array;
+}
+
+interface IndexedPoint {
+  x: number;
+  y: number;
+  status: number;
+  keys: Float64Array; // cell key per zoom level
+}
+
+/**
+ * Hierarchical grid clustering in the spirit of supercluster, but updatable in
+ * place: each zoom level buckets points into fixed pixel-sized cells, and a
+ * cell keeps its count, centroid sums and member IDs. Moving a vehicle costs
+ * one cell update per level, and a viewport query only visits the cells the
+ * bounds overlap at the requested zoom.
+ */
+export class ClusterIndex {
+  private levels: Map<number, ClusterCell>[] = [];
+  private cellsPerAxis: number[] = [];
+  private points: Map<string, IndexedPoint> = new Map();
+
+  constructor() {
+    for (let zoom = CLUSTER_MIN_ZOOM; zoom <= CLUSTER_MAX_ZOOM; zoom++) {
+      this.levels.push(new Map());
+      this.cellsPerAxis.push(Math.ceil((Math.pow(2, zoom) * 256) / CLUSTER_RADIUS_PX));
+    }
+  }
+
+  public get size(): number {
+    return this.points.size;
+  }
+
+  public upsert(id: string, latitude: number, longitude: number, status: number): void {
+    const [x, y] = projectToWorld(latitude, longitude);
+    const existing = this.points.get(id);
+
+    if (!existing) {
+      const point: IndexedPoint = { x, y, status, keys: new Float64Array(this.levels.length) };
+      for (let level = 0; level < this.levels.length; level++) {
+        point.keys[level] = this.keyOf(level, x, y);
+        this.addToCell(level, point.keys[level], id, point);
+      }
+      this.points.set(id, point);
+      return;
+    }
+    if (existing.status === status && existing.x === x && existing.y === y) return;
+
+    // Small moves keep their cell at most levels; those only adjust the centroid sums
+    const previous: IndexedPoint = { x: existing.x, y: existing.y, status: existing.status, keys: existing.keys };
+    existing.x = x;
+    existing.y = y;
+    existing.status = status;
+    for (let level = 0; level < this.levels.length; level++) {
+      const key = this.keyOf(level, x, y);
+      const oldKey = existing.keys[level];
+      if (key === oldKey) {
+        const cell = this.levels[level].get(key)!;
+        cell.sumX += x - previous.x;
+        cell.sumY += y - previous.y;
+        if (previous.status !== status) {
+          if (previous.status < STATUS_CODES.length) cell.statusCounts[previous.status]--;
+          if (status < STATUS_CODES.length) cell.statusCounts[status]++;
+        }
+      } else {
+        this.removeFromCell(level, oldKey, id, previous);
+        existing.keys[level] = key;
+        this.addToCell(level, key, id, existing);
+      }
+    }
+  }
+
+  public remove(id: string): void {
+    const point = this.points.get(id);
+    if (point) this.removePoint(id, point);
+  }
+
+  public clear(): void {
+    this.levels.forEach(cells => cells.clear());
+    this.points.clear();
+  }
+
+  public query(bounds: GeoBounds, zoom: number): ClusterFeature[] {
+    const [west, north] = projectToWorld(bounds.north, bounds.west);
+    const [east, south] = projectToWorld(bounds.south, bounds.east);
+    const features: ClusterFeature[] = [];
+
+    const clampedZoom = Math.max(CLUSTER_MIN_ZOOM, Math.round(zoom));
+    const expandAll = clampedZoom > CLUSTER_MAX_ZOOM;
+    const level = Math.min(clampedZoom, CLUSTER_MAX_ZOOM) - CLUSTER_MIN_ZOOM;
+    const cells = this.levels[level];
+    const perAxis = this.cellsPerAxis[level];
+
+    const minX = this.cellIndex(perAxis, west);
+    const maxX = this.cellIndex(perAxis, east);
+    const minY = this.cellIndex(perAxis, north);
+    const maxY = this.cellIndex(perAxis, south);
+
+    const emit = (key: number, cell: ClusterCell) => {
+      if (cell.count === 1 || expandAll) {
+        cell.ids.forEach(id => features.push(this.pointFeature(id)));
+        return;
+      }
+      const [latitude, longitude] = unprojectFromWorld(cell.sumX / cell.count, cell.sumY / cell.count);
+      features.push({
+        id: `c${clampedZoom}:${key}`,
+        latitude,
+        longitude,
+        count: cell.count,
+        status: this.dominantStatus(cell)
+      });
+    };
+
+    // Small viewports walk their cell range; zoomed-out ones scan the occupied cells
+    if ((maxX - minX + 1) * (maxY - minY + 1) <= cells.size) {
+      for (let cy = minY; cy <= maxY; cy++) {
+        for (let cx = minX; cx <= maxX; cx++) {
+          const key = cy * perAxis + cx;
+          const cell = cells.get(key);
+          if (cell) emit(key, cell);
+        }
+      }
+    } else {
+      cells.forEach((cell, key) => {
+        const cx = key % perAxis;
+        const cy = Math.floor(key / perAxis);
+        if (cx >= minX && cx <= maxX && cy >= minY && cy <= maxY) emit(key, cell);
+      });
+    }
+
+    return features;
+  }
+
+  private pointFeature(id: string): ClusterFeature {
+    const point = this.points.get(id)!;
+    const [latitude, longitude] = unprojectFromWorld(point.x, point.y);
+    return { id, latitude, longitude, count: 1, vehicleId: id, status: decodeStatus(point.status) };
+  }
+
+  private dominantStatus(cell: ClusterCell): VehicleStatus | undefined {
+    let best = -1;
+    let bestCount = 0;
+    cell.statusCounts.forEach((count, code) => {
+      if (count > bestCount) {
+        best = code;
+        bestCount = count;
+      }
+    });
+    return best >= 0 ? decodeStatus(best) : undefined;
+  }
+
+  private removePoint(id: string, point: IndexedPoint): void {
+    for (let level = 0; level < this.levels.length; level++) {
+      this.removeFromCell(level, point.keys[level], id, point);
+    }
+    this.points.delete(id);
+  }
+
+  private addToCell(level: number, key: number, id: string, point: IndexedPoint): void {
+    const cells = this.levels[level];
+    let cell = cells.get(key);
+    if (!cell) {
+      cell = { count: 0, sumX: 0, sumY: 0, ids: new Set(), statusCounts: new Uint32Array(STATUS_CODES.length) };
+      cells.set(key, cell);
+    }
+    cell.count++;
+    cell.sumX += point.x;
+    cell.sumY += point.y;
+    cell.ids.add(id);
+    if (point.status < STATUS_CODES.length) cell.statusCounts[point.status]++;
+  }
+
+  private removeFromCell(level: number, key: number, id: string, point: IndexedPoint): void {
+    const cells = this.levels[level];
+    const cell = cells.get(key);
+    if (!cell) return;
+    cell.count--;
+    cell.sumX -= point.x;
+    cell.sumY -= point.y;
+    cell.ids.delete(id);
+    if (point.status < STATUS_CODES.length) cell.statusCounts[point.status]--;
+    if (cell.count === 0) cells.delete(key);
+  }
+
+  private cellIndex(perAxis: number, world: number): number {
+    return Math.min(perAxis - 1, Math.max(0, Math.floor(world * perAxis)));
+  }
+
+  private keyOf(level: number, x: number, y: number): number {
+    const perAxis = this.cellsPerAxis[level];
+    return this.cellIndex(perAxis, y) * perAxis + this.cellIndex(perAxis, x);
+  }
+}
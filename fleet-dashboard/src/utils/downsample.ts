@@ -0,0 +1,85 @@
+// Point reduction for charts: the output never exceeds what the plot width can show.
+// Both return indices into the source columns, so callers pick the columns they need.
+
+// Largest-Triangle-Three-Buckets: keeps the visual shape of a line with `threshold` points
+export const lttb = (x: ArrayLike<number>, y: ArrayLike<number>, length: number, threshold: number): Uint32Array => {
+  if (threshold >= length || threshold < 3) {
+    return Uint32Array.from({ length }, (_, i) => i);
+  }
+
+  const indices = new Uint32Array(threshold);
+  const bucketSize = (length - 2) / (threshold - 2);
+  let selected = 0;
+  indices[0] = 0;
+
+  for (let bucket = 0; bucket < threshold - 2; bucket++) {
+    // Average of the next bucket is the third triangle vertex
+    const nextStart = Math.floor((bucket + 1) * bucketSize) + 1;
+    const nextEnd = Math.min(Math.floor((bucket + 2) * bucketSize) + 1, length);
+    let avgX = 0;
+    let avgY = 0;
+    for (let i = nextStart; i < nextEnd; i++) {
+      avgX += x[i];
+      avgY += y[i];
+    }
+    const nextCount = Math.max(1, nextEnd - nextStart);
+    avgX /= nextCount;
+    avgY /= nextCount;
+
+    const start = Math.floor(bucket * bucketSize) + 1;
+    const end = Math.floor((bucket + 1) * bucketSize) + 1;
+    const ax = x[selected];
+    const ay = y[selected];
+    let maxArea = -1;
+    let chosen = start;
+    for (let i = start; i < end; i++) {
+      const area = Math.abs((ax - avgX) * (y[i] - ay) - (ax - x[i]) * (avgY - ay));
+      if (area > maxArea) {
+        maxArea = area;
+        chosen = i;
+      }
+    }
+    indices[bucket + 1] = chosen;
+    selected = chosen;
+  }
+
+  indices[threshold - 1] = length - 1;
+  return indices;
+};
+
+// Min and max of each of `buckets` equal-width x ranges; preserves spikes that LTTB may smooth
+export const minMax = (x: ArrayLike<number>, y: ArrayLike<number>, length: number, buckets: number): Uint32Array => {
+  if (length === 0) return new Uint32Array(0);
+  if (length <= buckets * 2) return Uint32Array.from({ length }, (_, i) => i);
+
+  const x0 = x[0];
+  const span = x[length - 1] - x0 || 1;
+  const result: number[] = [];
+  let bucket = 0;
+  let minIndex = 0;
+  let maxIndex = 0;
+
+  const emit = () => {
+    if (minIndex === maxIndex) {
+      result.push(minIndex);
+    } else {
+      result.push(Math.min(minIndex, maxIndex), Math.max(minIndex, maxIndex));
+    }
+  };
+
+  for (let i = 0; i < length; i++) {
+    const current = Math.min(buckets - 1, Math.floor(((x[i] - x0) / span) * buckets));
+    if (current !== bucket) {
+      emit();
+      bucket = current;
+      minIndex = i;
+      maxIndex = i;
+    } else {
+      if (y[i] < y[minIndex]) minIndex = i;
+      if (y[i] > y[maxIndex]) maxIndex = i;
+    }
+  }
+  emit();
+
+  return Uint32Array.from(result);
+};
@@ -0,0 +1,285 @@
+import { VehicleData, VehicleStatus, FilterState } from '../types';
+import { IndexedFields } from './vehicleTable';
+import {
+  ParsedSearch,
+  NumericRange,
+  NGRAM_SIZE,
+  FUZZY_MIN_SIMILARITY,
+  idGrams,
+  parseSearchQuery,
+  matchesSearch
+} from './searchQuery';
+
+export const LOW_BATTERY_THRESHOLD = 20;
+
+// Battery percentage covered by each bucket of the battery range index
+const BATTERY_BUCKET_SIZE = 10;
+const BATTERY_BUCKETS = 100 / BATTERY_BUCKET_SIZE + 1;
+
+export type FilterCriteria = Pick<FilterState, 'status' | 'searchQuery' | 'lowBatteryOnly'>;
+
+const batteryBucketOf = (battery: number): number =>
+  Math.max(0, Math.min(BATTERY_BUCKETS - 1, Math.floor(battery / BATTERY_BUCKET_SIZE)));
+
+export const matchesFilters = (vehicle: VehicleData, filters: FilterCriteria): boolean => {
+  if (filters.status !== 'all' && vehicle.status !== filters.status) return false;
+  if (filters.lowBatteryOnly && !(vehicle.battery < LOW_BATTERY_THRESHOLD)) return false;
+  if (filters.searchQuery && !matchesSearch(vehicle, parseSearchQuery(filters.searchQuery))) {
+    return false;
+  }
+  return true;
+};
+
+// True when both filter states select the same vehicles (sorting and time range aside)
+export const sameFilterCriteria = (a: FilterCriteria, b: FilterCriteria): boolean =>
+  a.status === b.status &&
+  a.searchQuery === b.searchQuery &&
+  a.lowBatteryOnly === b.lowBatteryOnly;
+
+/**
+ * Secondary indexes over the fleet (status buckets, low-battery set, battery
+ * range buckets and an ID n-gram index) plus a cached filtered result. Search
+ * expressions pick their candidates from these indexes as well. Each upsert only moves the
+ * affected vehicle between buckets; the cached result is patched in place for
+ * content changes and rebuilt from the smallest candidate bucket when its
+ * membership changes.
+ */
+export class VehicleFilterIndex {
+  private byStatus: Map<VehicleStatus, Set<string>> = new Map();
+  private lowBattery: Set<string> = new Set();
+  private batteryBuckets: Set<string>[] = Array.from({ length: BATTERY_BUCKETS }, () => new Set<string>());
+  private grams: Map<string, Set<string>> = new Map();
+  private lowerIds: Map<string, string> = new Map();
+
+  private criteria: FilterCriteria | null = null;
+  private result: VehicleData[] = [];
+  private positions: Map<string, number> = new Map();
+  private membershipDirty: boolean = true;
+  private pendingContent: Map<string, VehicleData> = new Map();
+
+  // `previous` holds the indexed fields as they were before this write
+  public upsert(previous: IndexedFields | undefined, next: VehicleData): void {
+    const id = next.id;
+
+    if (!previous) {
+      this.indexId(id);
+    }
+
+    if (!previous || previous.status !== next.status) {
+      if (previous) {
+        this.byStatus.get(previous.status)?.delete(id);
+      }
+      this.statusBucket(next.status).add(id);
+    }
+
+    const wasLow = previous !== undefined && previous.battery < LOW_BATTERY_THRESHOLD;
+    const isLow = next.battery < LOW_BATTERY_THRESHOLD;
+    if (isLow && !wasLow) {
+      this.lowBattery.add(id);
+    } else if (!isLow && wasLow) {
+      this.lowBattery.delete(id);
+    }
+
+    const bucket = batteryBucketOf(next.battery);
+    if (!previous || batteryBucketOf(previous.battery) !== bucket) {
+      if (previous) this.batteryBuckets[batteryBucketOf(previous.battery)].delete(id);
+      this.batteryBuckets[bucket].add(id);
+    }
+
+    this.trackResultChange(id, next);
+  }
+
+  public remove(vehicle: VehicleData): void {
+    const id = vehicle.id;
+    this.byStatus.get(vehicle.status)?.delete(id);
+    this.lowBattery.delete(id);
+    this.batteryBuckets[batteryBucketOf(vehicle.battery)].delete(id);
+
+    const lowerId = this.lowerIds.get(id);
+    if (lowerId !== undefined) {
+      idGrams(lowerId).forEach(gram => {
+        const bucket = this.grams.get(gram);
+        bucket?.delete(id);
+        if (bucket && bucket.size === 0) this.grams.delete(gram);
+      });
+      this.lowerIds.delete(id);
+    }
+
+    if (this.positions.has(id)) {
+      this.membershipDirty = true;
+    }
+  }
+
+  public clear(): void {
+    this.byStatus.clear();
+    this.lowBattery.clear();
+    this.batteryBuckets.forEach(bucket => bucket.clear());
+    this.grams.clear();
+    this.lowerIds.clear();
+    this.result = [];
+    this.positions.clear();
+    this.pendingContent.clear();
+    this.membershipDirty = true;
+  }
+
+  public getStatusIds(status: VehicleStatus): ReadonlySet<string> {
+    return this.statusBucket(status);
+  }
+
+  public getLowBatteryIds(): ReadonlySet<string> {
+    return this.lowBattery;
+  }
+
+  // Returns the same array instance until a vehicle enters, leaves or changes within the result
+  public query(filters: FilterCriteria, vehicles: ReadonlyMap<string, VehicleData>): VehicleData[] {
+    if (!this.criteria || !sameFilterCriteria(this.criteria, filters)) {
+      this.criteria = {
+        status: filters.status,
+        searchQuery: filters.searchQuery,
+        lowBatteryOnly: filters.lowBatteryOnly
+      };
+      this.membershipDirty = true;
+    }
+
+    if (this.membershipDirty) {
+      this.rebuild(vehicles);
+    } else if (this.pendingContent.size > 0) {
+      const patched = this.result.slice();
+      this.pendingContent.forEach((vehicle, id) => {
+        patched[this.positions.get(id)!] = vehicle;
+      });
+      this.result = patched;
+      this.pendingContent.clear();
+    }
+
+    return this.result;
+  }
+
+  private trackResultChange(id: string, vehicle: VehicleData): void {
+    if (!this.criteria || this.membershipDirty) return;
+
+    const isMember = this.positions.has(id);
+    const matches = matchesFilters(vehicle, this.criteria);
+
+    if (isMember !== matches) {
+      this.membershipDirty = true;
+      this.pendingContent.clear();
+    } else if (isMember) {
+      this.pendingContent.set(id, vehicle);
+    }
+  }
+
+  private rebuild(vehicles: ReadonlyMap<string, VehicleData>): void {
+    const criteria = this.criteria!;
+    const result: VehicleData[] = [];
+    const candidates = this.smallestCandidateSet(criteria);
+
+    if (candidates) {
+      candidates.forEach(id => {
+        const vehicle = vehicles.get(id);
+        if (vehicle && matchesFilters(vehicle, criteria)) result.push(vehicle);
+      });
+    } else {
+      vehicles.forEach(vehicle => {
+        if (matchesFilters(vehicle, criteria)) result.push(vehicle);
+      });
+    }
+
+    this.result = result;
+    this.positions = new Map(result.map((vehicle, index) => [vehicle.id, index]));
+    this.pendingContent.clear();
+    this.membershipDirty = false;
+  }
+
+  private smallestCandidateSet(criteria: FilterCriteria): ReadonlySet<string> | null {
+    let smallest: ReadonlySet<string> | null = null;
+    const consider = (set: ReadonlySet<string>) => {
+      if (!smallest || set.size < smallest.size) smallest = set;
+    };
+
+    if (criteria.status !== 'all') consider(this.statusBucket(criteria.status));
+    if (criteria.lowBatteryOnly) consider(this.lowBattery);
+
+    if (criteria.searchQuery) {
+      const search: ParsedSearch = parseSearchQuery(criteria.searchQuery);
+      if (search.status) consider(this.statusBucket(search.status));
+      if (search.battery) consider(this.batteryCandidates(search.battery));
+      search.terms.forEach(term => {
+        if (term.length >= NGRAM_SIZE) consider(this.searchCandidates(term));
+      });
+      search.fuzzyTerms.forEach(term => {
+        if (term.length >= NGRAM_SIZE) consider(this.fuzzyCandidates(term));
+      });
+    }
+
+    return smallest;
+  }
+
+  // Intersects the n-gram buckets of the term; exact substring match is verified by the caller
+  private searchCandidates(term: string): ReadonlySet<string> {
+    const buckets = idGrams(term)
+      .map(gram => this.grams.get(gram))
+      .sort((a, b) => (a?.size ?? 0) - (b?.size ?? 0));
+
+    if (buckets.length === 0 || !buckets[0]) return new Set();
+
+    const [first, ...rest] = buckets as Set<string>[];
+    const candidates = new Set<string>();
+    first.forEach(id => {
+      if (rest.every(bucket => bucket.has(id))) candidates.add(id);
+    });
+    return candidates;
+  }
+
+  // IDs sharing enough of the term's n-grams; counted from the n-gram buckets alone
+  private fuzzyCandidates(term: string): ReadonlySet<string> {
+    const grams = Array.from(new Set(idGrams(term)));
+    const required = Math.ceil(grams.length * FUZZY_MIN_SIMILARITY);
+    const shared: Map<string, number> = new Map();
+    grams.forEach(gram => {
+      this.grams.get(gram)?.forEach(id => shared.set(id, (shared.get(id) ?? 0) + 1));
+    });
+
+    const candidates = new Set<string>();
+    shared.forEach((count, id) => {
+      if (count >= required) candidates.add(id);
+    });
+    return candidates;
+  }
+
+  // Union of the battery buckets overlapping the range; exact bounds are verified by the caller
+  private batteryCandidates(range: NumericRange): ReadonlySet<string> {
+    const first = batteryBucketOf(Math.max(0, range.min));
+    const last = batteryBucketOf(Math.min(100, range.max));
+    if (first === last) return this.batteryBuckets[first];
+
+    const candidates = new Set<string>();
+    for (let bucket = first; bucket <= last; bucket++) {
+      this.batteryBuckets[bucket].forEach(id => candidates.add(id));
+    }
+    return candidates;
+  }
+
+  private indexId(id: string): void {
+    if (this.lowerIds.has(id)) return;
+    const lowerId = id.toLowerCase();
+    this.lowerIds.set(id, lowerId);
+    idGrams(lowerId).forEach(gram => {
+      let bucket = this.grams.get(gram);
+      if (!bucket) {
+        bucket = new Set();
+        this.grams.set(gram, bucket);
+      }
+      bucket.add(id);
+    });
+  }
+
+  private statusBucket(status: VehicleStatus): Set<string> {
+    let bucket = this.byStatus.get(status);
+    if (!bucket) {
+      bucket = new Set();
+      this.byStatus.set(status, bucket);
+    }
+    return bucket;
+  }
+}
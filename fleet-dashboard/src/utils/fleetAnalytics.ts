@@ -0,0 +1,339 @@
+import { TimeRange, VehicleData } from '../types';
+
+const EARTH_RADIUS_KM = 6371;
+const DEG = Math.PI / 180;
+// Position jumps implying more than this are resyncs or bad fixes, not driving
+const MAX_PLAUSIBLE_KMH = 250;
+
+export const haversineKm = (lat1: number, lng1: number, lat2: number, lng2: number): number => {
+  const dLat = (lat2 - lat1) * DEG;
+  const dLng = (lng2 - lng1) * DEG;
+  const a = Math.sin(dLat / 2) ** 2 + Math.cos(lat1 * DEG) * Math.cos(lat2 * DEG) * Math.sin(dLng / 2) ** 2;
+  return 2 * EARTH_RADIUS_KM * Math.asin(Math.min(1, Math.sqrt(a)));
+};
+
+/**
+ * Welford mean and variance over a population whose members change: `replace`
+ * swaps one member's old value for its new one in O(1), so fleet-wide speed
+ * and battery statistics follow the current state of every vehicle.
+ */
+export class RunningStats {
+  private n: number = 0;
+  private m: number = 0;
+  private m2: number = 0;
+
+  public get count(): number {
+    return this.n;
+  }
+
+  public get mean(): number {
+    return this.m;
+  }
+
+  public get variance(): number {
+    return this.n > 1 ? Math.max(0, this.m2 / this.n) : 0;
+  }
+
+  public get stdDev(): number {
+    return Math.sqrt(this.variance);
+  }
+
+  public add(value: number): void {
+    this.n++;
+    const delta = value - this.m;
+    this.m += delta / this.n;
+    this.m2 += delta * (value - this.m);
+  }
+
+  public remove(value: number): void {
+    if (this.n <= 1) {
+      this.clear();
+      return;
+    }
+    const meanBefore = this.m;
+    this.n--;
+    this.m = (meanBefore * (this.n + 1) - value) / this.n;
+    this.m2 -= (value - meanBefore) * (value - this.m);
+  }
+
+  public replace(previous: number, next: number): void {
+    if (this.n === 0) {
+      this.add(next);
+      return;
+    }
+    // Removing `previous` and adding `next` in one step, n unchanged
+    const meanBefore = this.m;
+    this.m += (next - previous) / this.n;
+    this.m2 += (next - previous) * (next - this.m + previous - meanBefore);
+  }
+
+  public clear(): void {
+    this.n = 0;
+    this.m = 0;
+    this.m2 = 0;
+  }
+}
+
+// Totals over one trailing window
+export interface WindowAggregate {
+  updates: number;
+  distanceKm: number;
+  maxSpeed: number;
+  // Means of the fleet-wide averages sampled during the window
+  averageSpeed: number;
+  averageBattery: number;
+  averageMoving: number;
+}
+
+export interface RollupPoint {
+  time: number; // bucket start, epoch ms
+  averageSpeed: number;
+  averageBattery: number;
+  moving: number;
+  distanceKm: number;
+}
+
+/**
+ * Ring of fixed-width time buckets. Vehicle updates add distance and update
+ * counts; periodic samples add the fleet-wide means. A bucket is reset when
+ * the ring wraps onto it, so reading a window only touches `count` buckets
+ * and memory never grows. Used both for trailing windows and as the
+ * downsampled rollup behind each TimeRange sparkline.
+ */
+export class TimeBuckets {
+  public readonly bucketMs: number;
+  public readonly count: number;
+  private starts: Float64Array;
+  private updates: Float64Array;
+  private distance: Float64Array;
+  private maxSpeed: Float32Array;
+  private samples: Float64Array;
+  private speedSum: Float64Array;
+  private batterySum: Float64Array;
+  private movingSum: Float64Array;
+
+  constructor(bucketMs: number, count: number) {
+    this.bucketMs = bucketMs;
+    this.count = count;
+    this.starts = new Float64Array(count).fill(-1);
+    this.updates = new Float64Array(count);
+    this.distance = new Float64Array(count);
+    this.maxSpeed = new Float32Array(count);
+    this.samples = new Float64Array(count);
+    this.speedSum = new Float64Array(count);
+    this.batterySum = new Float64Array(count);
+    this.movingSum = new Float64Array(count);
+  }
+
+  public addUpdate(time: number, speed: number, distanceKm: number): void {
+    const i = this.bucketFor(time);
+    if (i < 0) return;
+    this.updates[i]++;
+    this.distance[i] += distanceKm;
+    if (speed > this.maxSpeed[i]) this.maxSpeed[i] = speed;
+  }
+
+  public addSample(time: number, averageSpeed: number, averageBattery: number, moving: number): void {
+    const i = this.bucketFor(time);
+    if (i < 0) return;
+    this.samples[i]++;
+    this.speedSum[i] += averageSpeed;
+    this.batterySum[i] += averageBattery;
+    this.movingSum[i] += moving;
+  }
+
+  public total(now: number): WindowAggregate {
+    const oldest = this.bucketStart(now) - (this.count - 1) * this.bucketMs;
+    const result: WindowAggregate = {
+      updates: 0, distanceKm: 0, maxSpeed: 0, averageSpeed: 0, averageBattery: 0, averageMoving: 0
+    };
+    let samples = 0;
+    for (let i = 0; i < this.count; i++) {
+      if (this.starts[i] < oldest || this.starts[i] > now) continue;
+      result.updates += this.updates[i];
+      result.distanceKm += this.distance[i];
+      result.maxSpeed = Math.max(result.maxSpeed, this.maxSpeed[i]);
+      samples += this.samples[i];
+      result.averageSpeed += this.speedSum[i];
+      result.averageBattery += this.batterySum[i];
+      result.averageMoving += this.movingSum[i];
+    }
+    if (samples > 0) {
+      result.averageSpeed /= samples;
+      result.averageBattery /= samples;
+      result.averageMoving /= samples;
+    }
+    return result;
+  }
+
+  // Buckets of the trailing window in time order; buckets without samples are skipped
+  public series(now: number): RollupPoint[] {
+    const points: RollupPoint[] = [];
+    const newest = this.bucketStart(now);
+    for (let start = newest - (this.count - 1) * this.bucketMs; start <= newest; start += this.bucketMs) {
+      const i = this.indexOf(start);
+      if (this.starts[i] !== start || this.samples[i] === 0) continue;
+      points.push({
+        time: start,
+        averageSpeed: this.speedSum[i] / this.samples[i],
+        averageBattery: this.batterySum[i] / this.samples[i],
+        moving: this.movingSum[i] / this.samples[i],
+        distanceKm: this.distance[i]
+      });
+    }
+    return points;
+  }
+
+  public clear(): void {
+    this.starts.fill(-1);
+  }
+
+  private bucketStart(time: number): number {
+    return Math.floor(time / this.bucketMs) * this.bucketMs;
+  }
+
+  private indexOf(start: number): number {
+    return Math.floor(start / this.bucketMs) % this.count;
+  }
+
+  // -1 for a time older than the bucket now holding its slot; late data never evicts newer
+  private bucketFor(time: number): number {
+    const start = this.bucketStart(time);
+    const i = this.indexOf(start);
+    if (start < this.starts[i]) return -1;
+    if (this.starts[i] !== start) {
+      this.starts[i] = start;
+      this.updates[i] = 0;
+      this.distance[i] = 0;
+      this.maxSpeed[i] = 0;
+      this.samples[i] = 0;
+      this.speedSum[i] = 0;
+      this.batterySum[i] = 0;
+      this.movingSum[i] = 0;
+    }
+    return i;
+  }
+}
+
+const MINUTE_MS = 60 * 1000;
+
+// Sparkline resolution per time range: ~60-100 points each
+const createRollups = (): Record<TimeRange, TimeBuckets> => {
+  const hour = new TimeBuckets(MINUTE_MS, 60);
+  return {
+    [TimeRange.LAST_HOUR]: hour,
+    [TimeRange.LAST_24H]: new TimeBuckets(15 * MINUTE_MS, 96),
+    [TimeRange.LAST_WEEK]: new TimeBuckets(2 * 60 * MINUTE_MS, 84),
+    // CUSTOM has no bounds in the filter state yet and shares the hour rollup
+    [TimeRange.CUSTOM]: hour
+  };
+};
+
+interface VehicleState {
+  latitude: number;
+  longitude: number;
+  time: number;
+  speed: number;
+  battery: number;
+}
+
+/**
+ * Fleet KPIs maintained from store deltas instead of polling the analytics
+ * endpoint. Each delta costs O(vehicles in it): the fleet speed and battery
+ * statistics swap each vehicle's old value for its new one, driven distance
+ * accumulates by haversine between consecutive positions, and both feed
+ * trailing 5-minute / 1-hour windows and one rollup per TimeRange. Time is
+ * taken from the telemetry timestamps, so a replay fills the same windows,
+ * but never later than the store received the update, so a device clock
+ * running ahead cannot move the windows past the data.
+ */
+export class StreamingFleetAnalytics {
+  public readonly speed = new RunningStats();
+  public readonly battery = new RunningStats();
+  public readonly lastFiveMinutes = new TimeBuckets(10 * 1000, 30);
+  public readonly rollups = createRollups();
+  public readonly lastHour = this.rollups[TimeRange.LAST_HOUR];
+  // Every distinct bucket ring, each fed once per update and sample
+  private buckets: TimeBuckets[] = Array.from(new Set([this.lastFiveMinutes, ...Object.values(this.rollups)]));
+  private vehicles: Map<string, VehicleState> = new Map();
+  private distanceKm: number = 0;
+  // Latest telemetry timestamp seen; the windows end here
+  private latest: number = 0;
+
+  public get totalDistanceKm(): number {
+    return this.distanceKm;
+  }
+
+  public get asOf(): number {
+    return this.latest;
+  }
+
+  public apply(changed: Iterable<VehicleData>): void {
+    for (const vehicle of changed) {
+      const parsed = vehicle.timestamp ? Date.parse(vehicle.timestamp) : NaN;
+      const time = Number.isNaN(parsed) ? vehicle.lastUpdate : Math.min(parsed, vehicle.lastUpdate);
+      if (time > this.latest) this.latest = time;
+
+      const state = this.vehicles.get(vehicle.id);
+      if (!state) {
+        this.vehicles.set(vehicle.id, {
+          latitude: vehicle.latitude,
+          longitude: vehicle.longitude,
+          time,
+          speed: vehicle.speed,
+          battery: vehicle.battery
+        });
+        this.speed.add(vehicle.speed);
+        this.battery.add(vehicle.battery);
+        this.addUpdate(time, vehicle.speed, 0);
+        continue;
+      }
+
+      this.speed.replace(state.speed, vehicle.speed);
+      this.battery.replace(state.battery, vehicle.battery);
+      let distance = 0;
+      if (time > state.time && (vehicle.latitude !== state.latitude || vehicle.longitude !== state.longitude)) {
+        const km = haversineKm(state.latitude, state.longitude, vehicle.latitude, vehicle.longitude);
+        if (km / ((time - state.time) / 3_600_000) <= MAX_PLAUSIBLE_KMH) distance = km;
+      }
+      this.distanceKm += distance;
+      this.addUpdate(time, vehicle.speed, distance);
+
+      state.latitude = vehicle.latitude;
+      state.longitude = vehicle.longitude;
+      state.time = Math.max(state.time, time);
+      state.speed = vehicle.speed;
+      state.battery = vehicle.battery;
+    }
+  }
+
+  // Vehicles leaving the table take their speed and battery with them; distance already driven stays
+  public remove(removed: Iterable<VehicleData>): void {
+    for (const vehicle of removed) {
+      const state = this.vehicles.get(vehicle.id);
+      if (!state) continue;
+      this.speed.remove(state.speed);
+      this.battery.remove(state.battery);
+      this.vehicles.delete(vehicle.id);
+    }
+  }
+
+  // Records the current fleet means into every window; call on a steady tick
+  public sample(moving: number): void {
+    if (this.latest === 0) return;
+    this.buckets.forEach(bucket => bucket.addSample(this.latest, this.speed.mean, this.battery.mean, moving));
+  }
+
+  public clear(): void {
+    this.vehicles.clear();
+    this.speed.clear();
+    this.battery.clear();
+    this.distanceKm = 0;
+    this.latest = 0;
+    this.buckets.forEach(bucket => bucket.clear());
+  }
+
+  private addUpdate(time: number, speed: number, distanceKm: number): void {
+    this.buckets.forEach(bucket => bucket.addUpdate(time, speed, distanceKm));
+  }
+}
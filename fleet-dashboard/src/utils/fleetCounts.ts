@@ -0,0 +1,49 @@
+import { FleetCounts, VehicleStatus } from '../types';
+import { IndexedFields } from './vehicleTable';
+import { LOW_BATTERY_THRESHOLD } from './filterIndex';
+
+// Fleet-wide counters, maintained by delta by whoever owns the vehicle table
+export const createCounts = (): FleetCounts => ({
+  total: 0,
+  online: 0,
+  lowBattery: 0,
+  byStatus: {
+    [VehicleStatus.ONLINE]: 0,
+    [VehicleStatus.MOVING]: 0,
+    [VehicleStatus.STOPPED]: 0,
+    [VehicleStatus.OFFLINE]: 0,
+    [VehicleStatus.LOW_BATTERY]: 0
+  }
+});
+
+const isOnline = (status: VehicleStatus) =>
+  status === VehicleStatus.ONLINE || status === VehicleStatus.MOVING;
+
+export const addToCounts = (counts: FleetCounts, vehicle: IndexedFields, sign: 1 | -1): void => {
+  counts.total += sign;
+  counts.byStatus[vehicle.status] = (counts.byStatus[vehicle.status] ?? 0) + sign;
+  if (isOnline(vehicle.status)) counts.online += sign;
+  if (vehicle.battery < LOW_BATTERY_THRESHOLD) counts.lowBattery += sign;
+};
+
+// Moves a vehicle between counters; false when its write changed nothing they count
+export const recountVehicle = (counts: FleetCounts, previous: IndexedFields | undefined, next: IndexedFields): boolean => {
+  if (!previous) {
+    addToCounts(counts, next, 1);
+    return true;
+  }
+  if (
+    previous.status !== next.status ||
+    (previous.battery < LOW_BATTERY_THRESHOLD) !== (next.battery < LOW_BATTERY_THRESHOLD)
+  ) {
+    addToCounts(counts, previous, -1);
+    addToCounts(counts, next, 1);
+    return true;
+  }
+  return false;
+};
+
+export const copyCounts = (counts: FleetCounts): FleetCounts => ({
+  ...counts,
+  byStatus: { ...counts.byStatus }
+});
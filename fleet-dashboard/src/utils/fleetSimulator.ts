@@ -0,0 +1,174 @@
+import { VehicleData, VehicleStatus } from '../types';
+import { LOW_BATTERY_THRESHOLD } from './filterIndex';
+
+const EARTH_RADIUS_M = 6_371_000;
+const DEG = Math.PI / 180;
+
+// Cruise speeds are drawn per vehicle between these, in km/h
+const MIN_CRUISE_KMH = 25;
+const MAX_CRUISE_KMH = 90;
+// Chance per second of a moving vehicle pulling over, and how long it stays
+const STOP_CHANCE_PER_S = 0.004;
+const MIN_DWELL_S = 20;
+const MAX_DWELL_S = 180;
+// Battery percent used per km driven, and gained per second while parked below the threshold
+const DRAIN_PER_KM = 0.25;
+const CHARGE_PER_S = 0.05;
+// Share of the fleet that never reports, so offline counts are realistic
+const OFFLINE_SHARE = 0.01;
+
+export interface FleetSimulatorOptions {
+  vehicles: number;
+  center?: [number, number];
+  radiusKm?: number;
+  seed?: number;
+}
+
+// Small deterministic PRNG, so benchmark runs replay the same fleet
+const mulberry32 = (seed: number) => () => {
+  seed = (seed + 0x6d2b79f5) | 0;
+  let t = Math.imul(seed ^ (seed >>> 15), 1 | seed);
+  t = (t + Math.imul(t ^ (t >>> 7), 61 | t)) ^ t;
+  return ((t ^ (t >>> 14)) >>> 0) / 4294967296;
+};
+
+/**
+ * Synthetic fleet driving around a city. Each vehicle cruises at its own
+ * speed with a wandering heading, stops now and then, drains its battery by
+ * distance and charges while parked, and turns back when it strays past the
+ * radius. State lives in typed columns, and `next(count)` advances only the
+ * vehicles it emits (round robin, by the time since their last report),
+ * so generating an update costs the same at 1k or 100k vehicles.
+ */
+export class FleetSimulator {
+  public readonly size: number;
+  private random: () => number;
+  private centerLat: number;
+  private centerLng: number;
+  private radiusM: number;
+  private ids: string[];
+  private latitude: Float64Array;
+  private longitude: Float64Array;
+  private heading: Float32Array; // radians, 0 = north
+  private speed: Float32Array; // km/h
+  private cruise: Float32Array;
+  private battery: Float32Array;
+  private dwellUntil: Float64Array;
+  private reportedAt: Float64Array;
+  private offline: Uint8Array;
+  private cursor: number = 0;
+
+  constructor(options: FleetSimulatorOptions) {
+    const { vehicles, center = [11.0168, 76.9558], radiusKm = 15, seed = 1 } = options;
+    this.size = vehicles;
+    this.random = mulberry32(seed);
+    [this.centerLat, this.centerLng] = center;
+    this.radiusM = radiusKm * 1000;
+
+    this.ids = new Array(vehicles);
+    this.latitude = new Float64Array(vehicles);
+    this.longitude = new Float64Array(vehicles);
+    this.heading = new Float32Array(vehicles);
+    this.speed = new Float32Array(vehicles);
+    this.cruise = new Float32Array(vehicles);
+    this.battery = new Float32Array(vehicles);
+    this.dwellUntil = new Float64Array(vehicles);
+    this.reportedAt = new Float64Array(vehicles);
+    this.offline = new Uint8Array(vehicles);
+
+    const width = String(vehicles).length;
+    for (let i = 0; i < vehicles; i++) {
+      this.ids[i] = `SIM-${String(i + 1).padStart(width, '0')}`;
+      // Uniform over the disc
+      const distance = Math.sqrt(this.random()) * this.radiusM;
+      const bearing = this.random() * 2 * Math.PI;
+      this.latitude[i] = this.centerLat + (distance * Math.cos(bearing)) / EARTH_RADIUS_M / DEG;
+      this.longitude[i] = this.centerLng
+        + (distance * Math.sin(bearing)) / (EARTH_RADIUS_M * Math.cos(this.centerLat * DEG)) / DEG;
+      this.heading[i] = this.random() * 2 * Math.PI;
+      this.cruise[i] = MIN_CRUISE_KMH + this.random() * (MAX_CRUISE_KMH - MIN_CRUISE_KMH);
+      this.speed[i] = this.cruise[i] * this.random();
+      this.battery[i] = 30 + this.random() * 70;
+      this.offline[i] = this.random() < OFFLINE_SHARE ? 1 : 0;
+    }
+  }
+
+  // Full state of every reporting vehicle, e.g. for a REST snapshot or the first message
+  public snapshot(now: number = Date.now()): VehicleData[] {
+    const vehicles: VehicleData[] = [];
+    for (let i = 0; i < this.size; i++) {
+      if (this.offline[i]) continue;
+      this.advance(i, now);
+      vehicles.push(this.toVehicle(i, now));
+    }
+    return vehicles;
+  }
+
+  // The next `count` vehicles in round-robin order, each moved up to `now`
+  public next(count: number, now: number = Date.now()): VehicleData[] {
+    const vehicles: VehicleData[] = [];
+    for (let n = 0; n < count && n < this.size; n++) {
+      const i = this.cursor;
+      this.cursor = (this.cursor + 1) % this.size;
+      if (this.offline[i]) continue;
+      this.advance(i, now);
+      vehicles.push(this.toVehicle(i, now));
+    }
+    return vehicles;
+  }
+
+  private advance(i: number, now: number): void {
+    const last = this.reportedAt[i] || now;
+    const dt = Math.min(60, (now - last) / 1000);
+    this.reportedAt[i] = now;
+    if (dt <= 0) return;
+
+    if (now < this.dwellUntil[i]) {
+      this.speed[i] = 0;
+      if (this.battery[i] < LOW_BATTERY_THRESHOLD + 10) {
+        this.battery[i] = Math.min(100, this.battery[i] + CHARGE_PER_S * dt);
+      }
+      return;
+    }
+    if (this.random() < STOP_CHANCE_PER_S * dt) {
+      this.dwellUntil[i] = now + (MIN_DWELL_S + this.random() * (MAX_DWELL_S - MIN_DWELL_S)) * 1000;
+      this.speed[i] = 0;
+      return;
+    }
+
+    // Ease toward cruise speed with some jitter, and let the heading wander
+    const target = this.cruise[i] * (0.7 + 0.3 * this.random());
+    this.speed[i] += (target - this.speed[i]) * Math.min(1, dt / 5);
+    this.heading[i] += (this.random() - 0.5) * 0.6 * Math.sqrt(dt);
+
+    const northM = (this.latitude[i] - this.centerLat) * DEG * EARTH_RADIUS_M;
+    const eastM = (this.longitude[i] - this.centerLng) * DEG * EARTH_RADIUS_M * Math.cos(this.centerLat * DEG);
+    if (northM * northM + eastM * eastM > this.radiusM * this.radiusM) {
+      // Head back toward the center
+      this.heading[i] = Math.atan2(-eastM, -northM) + (this.random() - 0.5) * 0.5;
+    }
+
+    const distanceM = (this.speed[i] / 3.6) * dt;
+    this.latitude[i] += (distanceM * Math.cos(this.heading[i])) / EARTH_RADIUS_M / DEG;
+    this.longitude[i] += (distanceM * Math.sin(this.heading[i]))
+      / (EARTH_RADIUS_M * Math.cos(this.latitude[i] * DEG)) / DEG;
+    this.battery[i] = Math.max(0, this.battery[i] - DRAIN_PER_KM * distanceM / 1000);
+  }
+
+  private toVehicle(i: number, now: number): VehicleData {
+    const speed = this.speed[i];
+    const battery = this.battery[i];
+    let status = speed > 1 ? VehicleStatus.MOVING : VehicleStatus.STOPPED;
+    if (battery < LOW_BATTERY_THRESHOLD) status = VehicleStatus.LOW_BATTERY;
+    return {
+      id: this.ids[i],
+      latitude: this.latitude[i],
+      longitude: this.longitude[i],
+      speed: Math.round(speed * 10) / 10,
+      battery: Math.round(battery * 10) / 10,
+      status,
+      timestamp: new Date(now).toISOString(),
+      lastUpdate: now
+    };
+  }
+}
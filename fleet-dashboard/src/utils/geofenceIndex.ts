@@ -0,0 +1,126 @@
+import { GeoBounds, Geofence } from '../types';
+
+// ~1.1 km cells: a depot or school zone covers a handful of cells
+const DEFAULT_CELL_DEGREES = 0.01;
+// Fences covering more cells than this are kept out of the grid and bbox-checked on every query
+const MAX_CELLS_PER_FENCE = 4096;
+
+// Geofence with its bounding box and vertices flattened for point-in-polygon tests
+export interface PreparedGeofence {
+  index: number;
+  fence: Geofence;
+  bounds: GeoBounds;
+  // lat0, lng0, lat1, lng1, …
+  vertices: Float64Array;
+}
+
+const prepare = (fence: Geofence, index: number): PreparedGeofence => {
+  const vertices = new Float64Array(fence.polygon.length * 2);
+  const bounds: GeoBounds = { south: Infinity, west: Infinity, north: -Infinity, east: -Infinity };
+  fence.polygon.forEach(([latitude, longitude], i) => {
+    vertices[i * 2] = latitude;
+    vertices[i * 2 + 1] = longitude;
+    bounds.south = Math.min(bounds.south, latitude);
+    bounds.north = Math.max(bounds.north, latitude);
+    bounds.west = Math.min(bounds.west, longitude);
+    bounds.east = Math.max(bounds.east, longitude);
+  });
+  return { index, fence, bounds, vertices };
+};
+
+// Even-odd ray cast; the ring is closed implicitly
+const insidePolygon = (vertices: Float64Array, latitude: number, longitude: number): boolean => {
+  let inside = false;
+  const n = vertices.length;
+  for (let i = 0, j = n - 2; i < n; j = i, i += 2) {
+    const latI = vertices[i];
+    const lngI = vertices[i + 1];
+    const latJ = vertices[j];
+    const lngJ = vertices[j + 1];
+    if ((latI > latitude) !== (latJ > latitude) &&
+        longitude < ((lngJ - lngI) * (latitude - latI)) / (latJ - latI) + lngI) {
+      inside = !inside;
+    }
+  }
+  return inside;
+};
+
+/**
+ * Static grid over geofence bounding boxes. Each cell lists the fences whose
+ * bbox overlaps it, so a point lookup reads one cell, rejects by bbox and
+ * only then runs point-in-polygon. Rebuilt whole when the fence set changes;
+ * fences do not cross the antimeridian.
+ */
+export class GeofenceIndex {
+  private fences: PreparedGeofence[] = [];
+  private cells: Map<number, number[]> = new Map();
+  private large: number[] = [];
+  private cellDegrees: number;
+  private columns: number;
+
+  constructor(cellDegrees: number = DEFAULT_CELL_DEGREES) {
+    this.cellDegrees = cellDegrees;
+    this.columns = Math.ceil(360 / cellDegrees) + 1;
+  }
+
+  public get size(): number {
+    return this.fences.length;
+  }
+
+  public get(index: number): PreparedGeofence {
+    return this.fences[index];
+  }
+
+  public load(fences: Geofence[]): void {
+    this.fences = fences.filter(fence => fence.polygon.length >= 3).map(prepare);
+    this.cells.clear();
+    this.large = [];
+
+    this.fences.forEach(({ index, bounds }) => {
+      const minRow = this.rowOf(bounds.south);
+      const maxRow = this.rowOf(bounds.north);
+      const minColumn = this.columnOf(bounds.west);
+      const maxColumn = this.columnOf(bounds.east);
+      if ((maxRow - minRow + 1) * (maxColumn - minColumn + 1) > MAX_CELLS_PER_FENCE) {
+        this.large.push(index);
+        return;
+      }
+      for (let row = minRow; row <= maxRow; row++) {
+        for (let column = minColumn; column <= maxColumn; column++) {
+          const key = this.keyOf(row, column);
+          const cell = this.cells.get(key);
+          if (cell) cell.push(index);
+          else this.cells.set(key, [index]);
+        }
+      }
+    });
+  }
+
+  // Appends the indexes of the fences containing the point to `out`
+  public query(latitude: number, longitude: number, out: number[]): number[] {
+    const cell = this.cells.get(this.keyOf(this.rowOf(latitude), this.columnOf(longitude)));
+    if (cell) this.collect(cell, latitude, longitude, out);
+    if (this.large.length > 0) this.collect(this.large, latitude, longitude, out);
+    return out;
+  }
+
+  private collect(candidates: number[], latitude: number, longitude: number, out: number[]): void {
+    for (let i = 0; i < candidates.length; i++) {
+      const { bounds, vertices, index } = this.fences[candidates[i]];
+      if (latitude < bounds.south || latitude > bounds.north || longitude < bounds.west || longitude > bounds.east) continue;
+      if (insidePolygon(vertices, latitude, longitude)) out.push(index);
+    }
+  }
+
+  private rowOf(latitude: number): number {
+    return Math.floor((Math.max(-90, Math.min(90, latitude)) + 90) / this.cellDegrees);
+  }
+
+  private columnOf(longitude: number): number {
+    return Math.floor((Math.max(-180, Math.min(180, longitude)) + 180) / this.cellDegrees);
+  }
+
+  private keyOf(row: number, column: number): number {
+    return row * this.columns + column;
+  }
+}
@@ -0,0 +1,236 @@
+import { IngestFocus, VehicleUpdate } from '../types';
+import { containsPoint } from './spatialGrid';
+
+// Shedding starts once a control period's lag exceeds this...
+const SHED_ENTER_LAG_MS = 1000;
+// ...and stops once lag has stayed below this for SHED_EXIT_HOLD_MS
+const SHED_EXIT_LAG_MS = 250;
+const SHED_EXIT_HOLD_MS = 5000;
+// Clock offset history: the minimum of each bucket, kept for BASELINE_BUCKETS buckets
+const BASELINE_BUCKET_MS = 60_000;
+const BASELINE_BUCKETS = 5;
+// Requested server rate: cut to this share of what arrived, at most once per interval
+const THROTTLE_DECREASE = 0.7;
+const THROTTLE_DECREASE_INTERVAL_MS = 3000;
+// Raised by this factor per period once recovered; lifted when the server sends well under it
+const THROTTLE_INCREASE = 1.25;
+const THROTTLE_LIFT_SHARE = 0.5;
+const MIN_THROTTLE_RATE = 50;
+// Deferred updates are released this often while shedding
+const CLUSTERED_RELEASE_MS = 1000;
+const OFFSCREEN_RELEASE_MS = 5000;
+
+/**
+ * Ingest lag from server timestamps. The raw difference between local receive
+ * time and the server's `timestamp` includes clock skew and network delay, so
+ * the lowest difference seen over the last few minutes is taken as the
+ * baseline and lag is how far a period's worst message sits above it.
+ */
+export class IngestLagEstimator {
+  private minima: number[] = [];
+  private bucketStart: number = -1;
+  private periodMax: number = -Infinity;
+
+  public observe(serverTime: number, now: number): void {
+    const offset = now - serverTime;
+    if (Number.isNaN(offset)) return;
+    if (this.bucketStart < 0 || now - this.bucketStart >= BASELINE_BUCKET_MS) {
+      this.bucketStart = now;
+      this.minima.push(offset);
+      if (this.minima.length > BASELINE_BUCKETS) this.minima.shift();
+    } else if (offset < this.minima[this.minima.length - 1]) {
+      this.minima[this.minima.length - 1] = offset;
+    }
+    if (offset > this.periodMax) this.periodMax = offset;
+  }
+
+  // Lag of the period since the last call, or null if nothing arrived
+  public take(): number | null {
+    if (this.periodMax === -Infinity) return null;
+    const lag = Math.max(0, this.periodMax - Math.min(...this.minima));
+    this.periodMax = -Infinity;
+    return lag;
+  }
+
+  public reset(): void {
+    this.minima = [];
+    this.bucketStart = -1;
+    this.periodMax = -Infinity;
+  }
+}
+
+export interface FlowDecision {
+  lagMs: number;
+  shedding: boolean;
+  // Server-side update rate to request; null asks for the full stream
+  maxUpdatesPerSecond: number | null;
+  // `maxUpdatesPerSecond` differs from the previous period
+  throttleChanged: boolean;
+}
+
+/**
+ * Once-per-period flow control: sheds locally while lag is high, with
+ * hysteresis so one slow frame does not flap the state, and asks the server
+ * for a lower rate AIMD-style — a multiplicative cut of the observed rate
+ * while behind, a gradual raise after recovery, and no limit once the server
+ * is no longer held back by it.
+ */
+export class IngestFlowController {
+  private lag = new IngestLagEstimator();
+  private shedding: boolean = false;
+  private calmSince: number | null = null;
+  private limit: number | null = null;
+  private lastDecrease: number = -Infinity;
+  private lastLag: number = 0;
+
+  public observe(serverTime: number, now: number): void {
+    this.lag.observe(serverTime, now);
+  }
+
+  // `receivedRate` is the updates per second that arrived during the period
+  public evaluate(now: number, receivedRate: number): FlowDecision {
+    const measured = this.lag.take();
+    // A silent period carries no evidence either way
+    const lagMs = measured ?? this.lastLag;
+    this.lastLag = lagMs;
+    const previousLimit = this.limit;
+
+    if (lagMs > SHED_ENTER_LAG_MS) {
+      this.shedding = true;
+      this.calmSince = null;
+      if (now - this.lastDecrease >= THROTTLE_DECREASE_INTERVAL_MS && receivedRate > 0) {
+        const base = Math.min(this.limit ?? Infinity, receivedRate);
+        this.limit = Math.max(MIN_THROTTLE_RATE, Math.floor(base * THROTTLE_DECREASE));
+        this.lastDecrease = now;
+      }
+    } else if (lagMs < SHED_EXIT_LAG_MS) {
+      if (this.calmSince === null) this.calmSince = now;
+      if (now - this.calmSince >= SHED_EXIT_HOLD_MS) {
+        this.shedding = false;
+        if (this.limit !== null) {
+          this.limit = receivedRate < this.limit * THROTTLE_LIFT_SHARE
+            ? null
+            : Math.ceil(this.limit * THROTTLE_INCREASE);
+        }
+      }
+    } else {
+      this.calmSince = null;
+    }
+
+    return {
+      lagMs,
+      shedding: this.shedding,
+      maxUpdatesPerSecond: this.limit,
+      throttleChanged: this.limit !== previousLimit
+    };
+  }
+
+  public reset(): void {
+    this.lag.reset();
+    this.shedding = false;
+    this.calmSince = null;
+    this.limit = null;
+    this.lastDecrease = -Infinity;
+    this.lastLag = 0;
+  }
+}
+
+/**
+ * Holds back updates the user cannot see while the client is behind.
+ * Vehicles in focus (selected or pinned) and on screen pass straight through;
+ * on-screen vehicles the map only draws as clusters are released once a
+ * second and off-screen vehicles every five. Held updates keep only the
+ * latest per vehicle, so a backlog collapses to one record per vehicle.
+ */
+export class LoadShedder {
+  private active: boolean = false;
+  private focus: IngestFocus = { bounds: null, clustered: false, vehicleIds: [] };
+  private focusIds: Set<string> = new Set();
+  private clustered: Map<string, VehicleUpdate> = new Map();
+  private offscreen: Map<string, VehicleUpdate> = new Map();
+  private lastClusteredRelease: number = 0;
+  private lastOffscreenRelease: number = 0;
+
+  public get deferred(): number {
+    return this.clustered.size + this.offscreen.size;
+  }
+
+  public setFocus(focus: IngestFocus): void {
+    this.focus = focus;
+    this.focusIds = new Set(focus.vehicleIds);
+  }
+
+  // Returns the updates still held when shedding stops, for immediate delivery
+  public setActive(active: boolean, now: number): VehicleUpdate[] {
+    this.active = active;
+    this.lastClusteredRelease = now;
+    this.lastOffscreenRelease = now;
+    return active ? [] : this.drain();
+  }
+
+  // Updates to deliver now; the rest are held
+  public admit(updates: VehicleUpdate[]): VehicleUpdate[] {
+    if (!this.active) return updates;
+    const immediate: VehicleUpdate[] = [];
+    const { bounds, clustered } = this.focus;
+    for (const update of updates) {
+      const { id, latitude, longitude } = update;
+      if (this.focusIds.has(id) || latitude === undefined || longitude === undefined) {
+        this.pass(update, immediate);
+      } else if (bounds && !containsPoint(bounds, latitude, longitude)) {
+        this.clustered.delete(id);
+        this.offscreen.set(id, update);
+      } else if (clustered) {
+        this.offscreen.delete(id);
+        this.clustered.set(id, update);
+      } else {
+        this.pass(update, immediate);
+      }
+    }
+    return immediate;
+  }
+
+  // Held update of one vehicle, removed; lets a patch be applied on top of it in order
+  public take(vehicleId: string): VehicleUpdate | undefined {
+    const held = this.clustered.get(vehicleId) ?? this.offscreen.get(vehicleId);
+    this.clustered.delete(vehicleId);
+    this.offscreen.delete(vehicleId);
+    return held;
+  }
+
+  // Held updates whose release interval has passed
+  public release(now: number): VehicleUpdate[] {
+    const released: VehicleUpdate[] = [];
+    if (now - this.lastClusteredRelease >= CLUSTERED_RELEASE_MS) {
+      this.lastClusteredRelease = now;
+      this.clustered.forEach(update => released.push(update));
+      this.clustered.clear();
+    }
+    if (now - this.lastOffscreenRelease >= OFFSCREEN_RELEASE_MS) {
+      this.lastOffscreenRelease = now;
+      this.offscreen.forEach(update => released.push(update));
+      this.offscreen.clear();
+    }
+    return released;
+  }
+
+  public clear(): void {
+    this.clustered.clear();
+    this.offscreen.clear();
+  }
+
+  private pass(update: VehicleUpdate, immediate: VehicleUpdate[]): void {
+    // A held older update must not be released over this one
+    if (this.deferred > 0) {
+      this.clustered.delete(update.id);
+      this.offscreen.delete(update.id);
+    }
+    immediate.push(update);
+  }
+
+  private drain(): VehicleUpdate[] {
+    const held = [...this.clustered.values(), ...this.offscreen.values()];
+    this.clear();
+    return held;
+  }
+}
@@ -0,0 +1,12 @@
+// Web Mercator in normalized world units matching Leaflet's EPSG:3857:
+// x and y in [0, 1], y growing southwards
+
+export const projectToWorld = (latitude: number, longitude: number): [number, number] => {
+  const sin = Math.max(Math.min(Math.sin((latitude * Math.PI) / 180), 0.9999), -0.9999);
+  return [longitude / 360 + 0.5, 0.5 - Math.log((1 + sin) / (1 - sin)) / (4 * Math.PI)];
+};
+
+export const unprojectFromWorld = (x: number, y: number): [number, number] => {
+  const latitude = (360 / Math.PI) * Math.atan(Math.exp((1 - 2 * y) * Math.PI)) - 90;
+  return [latitude, (x - 0.5) * 360];
+};
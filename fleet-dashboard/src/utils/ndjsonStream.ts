@@ -0,0 +1,41 @@
+// Incremental NDJSON reader: decodes chunks as they arrive and hands each
+// complete line to `onRow`, so the body is never buffered or parsed whole.
+export const readNdjson = async <T>(
+  stream: ReadableStream<Uint8Array>,
+  onRow: (row: T) => void,
+  onChunk?: () => void
+): Promise<void> => {
+  const reader = stream.getReader();
+  const decoder = new TextDecoder();
+  let buffered = '';
+
+  const flushLines = (final: boolean) => {
+    let start = 0;
+    let newline = buffered.indexOf('\n', start);
+    while (newline !== -1) {
+      const line = buffered.slice(start, newline).trim();
+      if (line) onRow(JSON.parse(line) as T);
+      start = newline + 1;
+      newline = buffered.indexOf('\n', start);
+    }
+    buffered = buffered.slice(start);
+    if (final && buffered.trim()) {
+      onRow(JSON.parse(buffered) as T);
+      buffered = '';
+    }
+  };
+
+  try {
+    for (;;) {
+      const { done, value } = await reader.read();
+      if (done) break;
+      buffered += decoder.decode(value, { stream: true });
+      flushLines(false);
+      onChunk?.();
+    }
+    buffered += decoder.decode();
+    flushLines(true);
+  } finally {
+    reader.releaseLock();
+  }
+};
@@ -0,0 +1,136 @@
+// Indexable skip list over (key, id) pairs: O(log n) insert, remove and
+// positional lookup. Each forward pointer records how many entries it skips,
+// which is what makes rank-based access (the list's visible window) cheap.
+
+const MAX_LEVEL = 24;
+const LEVEL_PROBABILITY = 0.25;
+
+interface SkipNode {
+  key: number;
+  id: string;
+  next: (SkipNode | null)[];
+  span: number[];
+}
+
+const compare = (key: number, id: string, node: SkipNode): number => {
+  if (key !== node.key) return key < node.key ? -1 : 1;
+  return id < node.id ? -1 : id > node.id ? 1 : 0;
+};
+
+const randomLevel = (): number => {
+  let level = 1;
+  while (level < MAX_LEVEL && Math.random() < LEVEL_PROBABILITY) level++;
+  return level;
+};
+
+export class OrderedIndex {
+  private head: SkipNode = { key: -Infinity, id: '', next: [null], span: [0] };
+  private level: number = 1;
+  private length: number = 0;
+
+  public get size(): number {
+    return this.length;
+  }
+
+  public insert(key: number, id: string): void {
+    const update: SkipNode[] = new Array(MAX_LEVEL);
+    const rank: number[] = new Array(MAX_LEVEL);
+    let node = this.head;
+
+    for (let i = this.level - 1; i >= 0; i--) {
+      rank[i] = i === this.level - 1 ? 0 : rank[i + 1];
+      while (node.next[i] && compare(key, id, node.next[i]!) > 0) {
+        rank[i] += node.span[i];
+        node = node.next[i]!;
+      }
+      update[i] = node;
+    }
+
+    const level = randomLevel();
+    if (level > this.level) {
+      for (let i = this.level; i < level; i++) {
+        rank[i] = 0;
+        update[i] = this.head;
+        this.head.next[i] = null;
+        this.head.span[i] = this.length;
+      }
+      this.level = level;
+    }
+
+    const inserted: SkipNode = { key, id, next: new Array(level), span: new Array(level) };
+    for (let i = 0; i < level; i++) {
+      inserted.next[i] = update[i].next[i];
+      update[i].next[i] = inserted;
+      inserted.span[i] = update[i].span[i] - (rank[0] - rank[i]);
+      update[i].span[i] = rank[0] - rank[i] + 1;
+    }
+    for (let i = level; i < this.level; i++) {
+      update[i].span[i]++;
+    }
+    this.length++;
+  }
+
+  public remove(key: number, id: string): boolean {
+    const update: SkipNode[] = new Array(MAX_LEVEL);
+    let node = this.head;
+
+    for (let i = this.level - 1; i >= 0; i--) {
+      while (node.next[i] && compare(key, id, node.next[i]!) > 0) {
+        node = node.next[i]!;
+      }
+      update[i] = node;
+    }
+
+    const target = node.next[0];
+    if (!target || compare(key, id, target) !== 0) return false;
+
+    for (let i = 0; i < this.level; i++) {
+      if (update[i].next[i] === target) {
+        update[i].span[i] += target.span[i] - 1;
+        update[i].next[i] = target.next[i];
+      } else {
+        update[i].span[i]--;
+      }
+    }
+    while (this.level > 1 && !this.head.next[this.level - 1]) {
+      this.level--;
+    }
+    this.length--;
+    return true;
+  }
+
+  // ID at zero-based position `index`, or undefined when out of range
+  public at(index: number): string | undefined {
+    return this.nodeAt(index)?.id;
+  }
+
+  // IDs in positions [start, end): one positional lookup, then a walk along the bottom level
+  public slice(start: number, end: number): string[] {
+    const ids: string[] = [];
+    const first = this.nodeAt(Math.max(0, start));
+    for (let node = first, i = Math.max(0, start); node && i < end; node = node.next[0], i++) {
+      ids.push(node.id);
+    }
+    return ids;
+  }
+
+  public clear(): void {
+    this.head = { key: -Infinity, id: '', next: [null], span: [0] };
+    this.level = 1;
+    this.length = 0;
+  }
+
+  private nodeAt(index: number): SkipNode | null {
+    if (index < 0 || index >= this.length) return null;
+    let node = this.head;
+    let traversed = -1;
+    for (let i = this.level - 1; i >= 0; i--) {
+      while (node.next[i] && traversed + node.span[i] <= index) {
+        traversed += node.span[i];
+        node = node.next[i]!;
+      }
+      if (traversed === index) return node;
+    }
+    return null;
+  }
+}
@@ -0,0 +1,337 @@
+// Instrumentation is compiled in but does nothing unless enabled
+export const PERF_METRICS = import.meta.env.VITE_PERF_METRICS === 'true';
+// Also emit User Timing measures, visible in the DevTools performance panel
+const PERF_TRACE = PERF_METRICS && import.meta.env.VITE_PERF_TRACE === 'true';
+
+// Histogram range: 0.01 ms (or units) to ~170 s in buckets ~19% wide
+const HISTOGRAM_MIN = 0.01;
+const BUCKETS_PER_OCTAVE = 4;
+const HISTOGRAM_BUCKETS = 24 * BUCKETS_PER_OCTAVE + 2;
+
+// Length of one sampling window
+export const METRICS_WINDOW_MS = 1000;
+// Vehicles per store delta whose server timestamp is turned into a latency sample
+const LATENCY_SAMPLES_PER_DELTA = 8;
+// Bound on samples waiting for a commit, should the layer stop drawing
+const MAX_PENDING_LATENCY_SAMPLES = 256;
+
+export enum PerfCounter {
+  MESSAGES = 'ws.messages',
+  BYTES = 'ws.bytes',
+  UPDATES = 'batch.updates',
+  // Vehicle updates held back by load shedding
+  DEFERRED = 'ws.deferred',
+  // Binary records skipped because their slot had no dictionary entry
+  UNKNOWN_SLOTS = 'ws.unknown_slots'
+}
+
+export enum PerfHistogram {
+  PARSE = 'ws.parse_ms',
+  BATCH_SIZE = 'batch.size',
+  // Oldest queued update to the end of its store commit
+  BATCH_WAIT = 'batch.wait_ms',
+  FLUSH = 'batch.flush_ms',
+  STORE_UPDATE = 'store.update_ms',
+  REACT_COMMIT = 'react.commit_ms',
+  MAP_UPDATE = 'map.update_ms',
+  // Server `timestamp` to the first frame after the map layer drew the update
+  LATENCY = 'latency.e2e_ms'
+}
+
+// A histogram as plain data, for posting between threads
+export interface HistogramData {
+  counts: Uint32Array;
+  total: number;
+  sum: number;
+  min: number;
+  max: number;
+}
+
+export interface HistogramSummary {
+  count: number;
+  min: number;
+  max: number;
+  mean: number;
+  p50: number;
+  p90: number;
+  p99: number;
+}
+
+/**
+ * Log-bucketed histogram: recording is one log2 and an array increment, and
+ * percentiles are accurate to a bucket width (~19%). Histograms of the same
+ * layout merge by adding counts, so windows can be rolled up for export.
+ */
+export class Histogram {
+  private counts = new Uint32Array(HISTOGRAM_BUCKETS);
+  private total: number = 0;
+  private sum: number = 0;
+  private min: number = Infinity;
+  private max: number = 0;
+
+  public get count(): number {
+    return this.total;
+  }
+
+  public record(value: number): void {
+    const bucket = value <= HISTOGRAM_MIN
+      ? 0
+      : Math.min(HISTOGRAM_BUCKETS - 1, Math.floor(Math.log2(value / HISTOGRAM_MIN) * BUCKETS_PER_OCTAVE) + 1);
+    this.counts[bucket]++;
+    this.total++;
+    this.sum += value;
+    if (value < this.min) this.min = value;
+    if (value > this.max) this.max = value;
+  }
+
+  public merge(other: Histogram | HistogramData): void {
+    for (let i = 0; i < HISTOGRAM_BUCKETS; i++) this.counts[i] += other.counts[i];
+    this.total += other.total;
+    this.sum += other.sum;
+    this.min = Math.min(this.min, other.min);
+    this.max = Math.max(this.max, other.max);
+  }
+
+  public toData(): HistogramData {
+    return { counts: this.counts.slice(), total: this.total, sum: this.sum, min: this.min, max: this.max };
+  }
+
+  // Geometric middle of the bucket holding the p-th quantile, clamped to the observed range
+  public percentile(p: number): number {
+    if (this.total === 0) return 0;
+    const rank = Math.max(1, Math.ceil(p * this.total));
+    let seen = 0;
+    for (let i = 0; i < HISTOGRAM_BUCKETS; i++) {
+      seen += this.counts[i];
+      if (seen < rank) continue;
+      const middle = i === 0 ? HISTOGRAM_MIN : HISTOGRAM_MIN * 2 ** ((i - 0.5) / BUCKETS_PER_OCTAVE);
+      return Math.min(this.max, Math.max(this.min, middle));
+    }
+    return this.max;
+  }
+
+  public summary(): HistogramSummary {
+    return {
+      count: this.total,
+      min: this.total === 0 ? 0 : this.min,
+      max: this.max,
+      mean: this.total === 0 ? 0 : this.sum / this.total,
+      p50: this.percentile(0.5),
+      p90: this.percentile(0.9),
+      p99: this.percentile(0.99)
+    };
+  }
+
+  public reset(): void {
+    this.counts.fill(0);
+    this.total = 0;
+    this.sum = 0;
+    this.min = Infinity;
+    this.max = 0;
+  }
+}
+
+// Everything recorded during one sampling window
+export interface MetricsWindow {
+  start: number;
+  end: number;
+  counters: Record<PerfCounter, number>;
+  histograms: Record<PerfHistogram, Histogram>;
+}
+
+// A window recorded in a worker, posted to the main thread; empty histograms are left out
+export interface MetricsSnapshot {
+  counters: Record<PerfCounter, number>;
+  histograms: Partial<Record<PerfHistogram, HistogramData>>;
+}
+
+type MetricsWindowHandler = (window: MetricsWindow) => void;
+
+const createCounters = (): Record<PerfCounter, number> => ({
+  [PerfCounter.MESSAGES]: 0,
+  [PerfCounter.BYTES]: 0,
+  [PerfCounter.UPDATES]: 0,
+  [PerfCounter.DEFERRED]: 0,
+  [PerfCounter.UNKNOWN_SLOTS]: 0
+});
+
+export const createHistograms = (): Record<PerfHistogram, Histogram> => {
+  const histograms = {} as Record<PerfHistogram, Histogram>;
+  Object.values(PerfHistogram).forEach(name => {
+    histograms[name] = new Histogram();
+  });
+  return histograms;
+};
+
+let counters = createCounters();
+let histograms = createHistograms();
+let windowStart = Date.now();
+const windowHandlers: Set<MetricsWindowHandler> = new Set();
+let windowTimer: ReturnType<typeof setInterval> | null = null;
+
+// Hands the finished window to subscribers and starts a fresh one
+const closeWindow = (): void => {
+  const end = Date.now();
+  const finished: MetricsWindow = { start: windowStart, end, counters, histograms };
+  counters = createCounters();
+  histograms = createHistograms();
+  windowStart = end;
+  if (PERF_TRACE) Object.values(PerfHistogram).forEach(name => performance.clearMeasures(name));
+  windowHandlers.forEach(handler => handler(finished));
+};
+
+// Windows are only cut while someone listens; starts the clock on first subscribe
+export const onMetricsWindow = (handler: MetricsWindowHandler): (() => void) => {
+  windowHandlers.add(handler);
+  if (!windowTimer) {
+    counters = createCounters();
+    histograms = createHistograms();
+    windowStart = Date.now();
+    windowTimer = setInterval(closeWindow, METRICS_WINDOW_MS);
+  }
+  return () => {
+    windowHandlers.delete(handler);
+    if (windowHandlers.size === 0 && windowTimer) {
+      clearInterval(windowTimer);
+      windowTimer = null;
+    }
+  };
+};
+
+export const toMetricsSnapshot = (metrics: MetricsWindow): MetricsSnapshot => {
+  const snapshot: MetricsSnapshot = { counters: { ...metrics.counters }, histograms: {} };
+  Object.values(PerfHistogram).forEach((name) => {
+    if (metrics.histograms[name].count > 0) snapshot.histograms[name] = metrics.histograms[name].toData();
+  });
+  return snapshot;
+};
+
+// Each thread records into its own registry; the main thread folds the windows of the
+// ingest worker into its current one, so the HUD, exporter and benchmark see both
+export const mergeMetrics = (snapshot: MetricsSnapshot): void => {
+  if (!PERF_METRICS) return;
+  Object.values(PerfCounter).forEach((name) => {
+    counters[name] += snapshot.counters[name] ?? 0;
+  });
+  Object.values(PerfHistogram).forEach((name) => {
+    const data = snapshot.histograms[name];
+    if (data) histograms[name].merge(data);
+  });
+};
+
+// Posts every window recorded in this worker; the receiving client calls mergeMetrics
+export const forwardMetricsWindows = (send: (snapshot: MetricsSnapshot) => void): (() => void) =>
+  PERF_METRICS ? onMetricsWindow(metrics => send(toMetricsSnapshot(metrics))) : () => {};
+
+// Totals, rates and histogram summaries over a run of windows
+export interface MetricsSummary {
+  start: number;
+  end: number;
+  counters: Record<string, { total: number; perSecond: number }>;
+  histograms: Record<string, HistogramSummary>;
+}
+
+// Rolls consecutive windows up into one period, e.g. an export interval or a benchmark run
+export class MetricsAccumulator {
+  private totals = createCounters();
+  private histograms = createHistograms();
+  private start: number | null = null;
+  private end: number = 0;
+
+  public get empty(): boolean {
+    return this.start === null;
+  }
+
+  public add(metrics: MetricsWindow): void {
+    if (this.start === null) this.start = metrics.start;
+    this.end = metrics.end;
+    Object.values(PerfCounter).forEach((name) => {
+      this.totals[name] += metrics.counters[name];
+    });
+    Object.values(PerfHistogram).forEach((name) => {
+      this.histograms[name].merge(metrics.histograms[name]);
+    });
+  }
+
+  // Summarizes the period so far and starts a new one; histograms without samples are left out
+  public take(): MetricsSummary {
+    const start = this.start ?? Date.now();
+    const end = this.start === null ? start : this.end;
+    const seconds = Math.max(1, (end - start) / 1000);
+    const summary: MetricsSummary = { start, end, counters: {}, histograms: {} };
+    Object.values(PerfCounter).forEach((name) => {
+      summary.counters[name] = { total: this.totals[name], perSecond: this.totals[name] / seconds };
+    });
+    Object.values(PerfHistogram).forEach((name) => {
+      if (this.histograms[name].count > 0) summary.histograms[name] = this.histograms[name].summary();
+    });
+    this.totals = createCounters();
+    this.histograms = createHistograms();
+    this.start = null;
+    return summary;
+  }
+}
+
+// Benchmark builds expose collection to the headless harness: `fleetMetrics.collect()`
+// starts a period and returns a function that ends it and yields its summary
+export const exposeMetricsForBenchmark = (): void => {
+  (globalThis as { fleetMetrics?: unknown }).fleetMetrics = {
+    collect: (): (() => MetricsSummary) => {
+      const accumulator = new MetricsAccumulator();
+      const unsubscribe = onMetricsWindow(metrics => accumulator.add(metrics));
+      return () => {
+        unsubscribe();
+        return accumulator.take();
+      };
+    }
+  };
+};
+
+// Start time for perfMeasure; 0 (and no clock read) when instrumentation is off
+export const perfStart = (): number => (PERF_METRICS ? performance.now() : 0);
+
+export const perfMeasure = (name: PerfHistogram, start: number): void => {
+  if (!PERF_METRICS) return;
+  const end = performance.now();
+  histograms[name].record(end - start);
+  if (PERF_TRACE) performance.measure(name, { start, end });
+};
+
+export const perfRecord = (name: PerfHistogram, value: number): void => {
+  if (PERF_METRICS) histograms[name].record(value);
+};
+
+export const perfCount = (name: PerfCounter, amount: number = 1): void => {
+  if (PERF_METRICS) counters[name] += amount;
+};
+
+/**
+ * Turns a few server timestamps per store delta into end-to-end latency
+ * samples. `sample` picks them up as the delta arrives; `commit` is called
+ * once the map layer has been handed the change and records them on the
+ * next animation frame, i.e. when the update reaches the screen.
+ */
+export class LatencySampler {
+  private pending: number[] = [];
+  private frameRequested: boolean = false;
+
+  public sample(vehicles: ArrayLike<{ timestamp: string }>): void {
+    if (!PERF_METRICS) return;
+    const step = Math.max(1, Math.floor(vehicles.length / LATENCY_SAMPLES_PER_DELTA));
+    for (let i = 0; i < vehicles.length && this.pending.length < MAX_PENDING_LATENCY_SAMPLES; i += step) {
+      const time = Date.parse(vehicles[i].timestamp);
+      if (!Number.isNaN(time)) this.pending.push(time);
+    }
+  }
+
+  public commit(): void {
+    if (!PERF_METRICS || this.frameRequested || this.pending.length === 0) return;
+    this.frameRequested = true;
+    requestAnimationFrame(() => {
+      const now = Date.now();
+      this.pending.forEach(time => perfRecord(PerfHistogram.LATENCY, now - time));
+      this.pending = [];
+      this.frameRequested = false;
+    });
+  }
+}
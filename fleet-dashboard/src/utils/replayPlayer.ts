@@ -0,0 +1,96 @@
+import { VehicleUpdate } from '../types';
+import { ReplayTimeline } from './replayTimeline';
+
+export const MIN_REPLAY_SPEED = 1;
+export const MAX_REPLAY_SPEED = 100;
+// Playback tick; matches the default live batch interval
+const TICK_MS = 100;
+
+export type ReplayApply = (updates: Map<string, VehicleUpdate>) => void;
+export type ReplayTickHandler = (time: number, playing: boolean) => void;
+
+/**
+ * Plays a ReplayTimeline through the same update path as live telemetry. Each
+ * tick advances replay time by the elapsed wall time times the speed and
+ * applies only the vehicles that reported in between.
+ */
+export class ReplayPlayer {
+  private timeline: ReplayTimeline;
+  private apply: ReplayApply;
+  private currentTime: number;
+  private currentSpeed: number = MIN_REPLAY_SPEED;
+  private timer: number | null = null;
+  private lastTick: number = 0;
+  private tickHandlers: Set<ReplayTickHandler> = new Set();
+
+  constructor(timeline: ReplayTimeline, apply: ReplayApply) {
+    this.timeline = timeline;
+    this.apply = apply;
+    this.currentTime = timeline.start;
+  }
+
+  public get time(): number {
+    return this.currentTime;
+  }
+
+  public get speed(): number {
+    return this.currentSpeed;
+  }
+
+  public get playing(): boolean {
+    return this.timer !== null;
+  }
+
+  public onTick(handler: ReplayTickHandler): () => void {
+    this.tickHandlers.add(handler);
+    return () => this.tickHandlers.delete(handler);
+  }
+
+  public play(): void {
+    if (this.timer !== null) return;
+    if (this.currentTime >= this.timeline.end) this.seek(this.timeline.start);
+    this.lastTick = performance.now();
+    this.timer = setInterval(() => this.tick(), TICK_MS);
+    this.notify();
+  }
+
+  public pause(): void {
+    if (this.timer === null) return;
+    clearInterval(this.timer);
+    this.timer = null;
+    this.notify();
+  }
+
+  public setSpeed(speed: number): void {
+    this.currentSpeed = Math.max(MIN_REPLAY_SPEED, Math.min(MAX_REPLAY_SPEED, speed));
+  }
+
+  public seek(time: number): void {
+    this.currentTime = Math.max(this.timeline.start, Math.min(this.timeline.end, time));
+    this.apply(this.timeline.seek(this.currentTime));
+    this.notify();
+  }
+
+  public destroy(): void {
+    this.pause();
+    this.tickHandlers.clear();
+  }
+
+  private tick(): void {
+    const now = performance.now();
+    this.currentTime = Math.min(this.timeline.end, this.currentTime + (now - this.lastTick) * this.currentSpeed);
+    this.lastTick = now;
+
+    const updates = this.timeline.advance(this.currentTime);
+    if (updates.size > 0) this.apply(updates);
+    if (this.currentTime >= this.timeline.end) {
+      this.pause();
+    } else {
+      this.notify();
+    }
+  }
+
+  private notify(): void {
+    this.tickHandlers.forEach(handler => handler(this.currentTime, this.playing));
+  }
+}
@@ -0,0 +1,221 @@
+import { VehicleStatus, VehicleUpdate } from '../types';
+import { decodeStatus } from './telemetryCodec';
+import { TelemetrySeries } from './telemetrySeries';
+
+// ~2 minute resolution over 24 h; 18 bytes per sample, ~13 KB per vehicle
+export const DEFAULT_TRACK_CAPACITY = 720;
+// Spacing of the per-vehicle cursor snapshots used to start a seek
+export const KEYFRAME_INTERVAL_MS = 15 * 60 * 1000;
+
+/**
+ * Fixed-capacity buffer of one vehicle's samples in time order, so memory per
+ * vehicle never grows. Once full, further samples are dropped rather than
+ * evicting the oldest, so the start of the window is never lost; callers
+ * decimate to the capacity first. Times are ms offsets from the timeline
+ * start; coordinates are float32 (~10 cm).
+ */
+export class TrackBuffer {
+  public readonly capacity: number;
+  private offset: Uint32Array;
+  private latitude: Float32Array;
+  private longitude: Float32Array;
+  private speed: Float32Array;
+  private battery: Uint8Array;
+  private status: Uint8Array;
+  private count: number = 0;
+
+  constructor(capacity: number) {
+    this.capacity = capacity;
+    this.offset = new Uint32Array(capacity);
+    this.latitude = new Float32Array(capacity);
+    this.longitude = new Float32Array(capacity);
+    this.speed = new Float32Array(capacity);
+    this.battery = new Uint8Array(capacity);
+    this.status = new Uint8Array(capacity);
+  }
+
+  public get size(): number {
+    return this.count;
+  }
+
+  // Out-of-order samples and samples past capacity are dropped; returns whether the sample was kept
+  public push(offset: number, latitude: number, longitude: number, speed: number, battery: number, status: number): boolean {
+    if (this.count === this.capacity) return false;
+    if (this.count > 0 && offset < this.offsetAt(this.count - 1)) return false;
+    const slot = this.count++;
+    this.offset[slot] = offset;
+    this.latitude[slot] = latitude;
+    this.longitude[slot] = longitude;
+    this.speed[slot] = speed;
+    this.battery[slot] = battery;
+    this.status[slot] = status;
+    return true;
+  }
+
+  // `index` counts from the oldest sample
+  public offsetAt(index: number): number {
+    return this.offset[index];
+  }
+
+  // Last sample at or before `offset` within [lo, hi), or lo - 1 when there is none
+  public indexAtOrBefore(offset: number, lo: number = 0, hi: number = this.count): number {
+    let low = lo;
+    let high = hi;
+    while (low < high) {
+      const mid = (low + high) >>> 1;
+      if (this.offsetAt(mid) <= offset) low = mid + 1;
+      else high = mid;
+    }
+    return low - 1;
+  }
+
+  public toUpdate(id: string, index: number, baseTime: number): VehicleUpdate {
+    const slot = index;
+    return {
+      id,
+      latitude: this.latitude[slot],
+      longitude: this.longitude[slot],
+      speed: this.speed[slot],
+      battery: this.battery[slot],
+      status: decodeStatus(this.status[slot]) ?? VehicleStatus.ONLINE,
+      timestamp: new Date(baseTime + this.offset[slot]).toISOString()
+    };
+  }
+}
+
+/**
+ * Fleet history between two instants, one TrackBuffer per vehicle. After `seal()`,
+ * keyframes hold every vehicle's sample index at fixed intervals: a seek picks
+ * the keyframe in O(1) and binary-searches only the samples up to the next one.
+ * Forward playback walks per-vehicle cursors and emits only vehicles that moved.
+ */
+export class ReplayTimeline {
+  public readonly start: number;
+  public readonly end: number;
+  private capacity: number;
+  // Width of the time buckets each track keeps one sample of
+  private bucketMs: number;
+  private dropped: number = 0;
+  private ids: string[] = [];
+  private tracks: TrackBuffer[] = [];
+  private slots: Map<string, number> = new Map();
+  // keyframeCount x vehicles, row-major; -1 where a vehicle has no sample yet
+  private keyframes: Int32Array = new Int32Array(0);
+  private keyframeCount: number = 0;
+  private cursors: Int32Array = new Int32Array(0);
+  private cursorTime: number = -1;
+
+  constructor(start: number, end: number, capacity: number = DEFAULT_TRACK_CAPACITY) {
+    this.start = start;
+    this.end = end;
+    this.capacity = capacity;
+    this.bucketMs = Math.max(1, Math.ceil((end - start + 1) / capacity));
+  }
+
+  public get vehicleCount(): number {
+    return this.ids.length;
+  }
+
+  // In-window rows left out by decimation, e.g. when the server ignored the interval hint
+  public get droppedSamples(): number {
+    return this.dropped;
+  }
+
+  // Copies the in-window rows of a fetched series into the vehicle's track, keeping
+  // the first row of each of `capacity` equal time buckets over [start, end], so a
+  // denser series than the track holds still covers the whole window
+  public addSeries(series: TelemetrySeries): void {
+    const track = this.trackFor(series.vehicleId);
+    let lastBucket = track.size > 0 ? Math.floor(track.offsetAt(track.size - 1) / this.bucketMs) : -1;
+    for (let i = 0; i < series.length; i++) {
+      const time = series.timestamp[i];
+      if (time < this.start || time > this.end) continue;
+      const offset = time - this.start;
+      const bucket = Math.floor(offset / this.bucketMs);
+      if (bucket <= lastBucket ||
+        !track.push(offset, series.latitude[i], series.longitude[i], series.speed[i], series.battery[i], series.status[i])) {
+        this.dropped++;
+        continue;
+      }
+      lastBucket = bucket;
+    }
+  }
+
+  // Builds the keyframes; call once loading is complete
+  public seal(): void {
+    const vehicles = this.tracks.length;
+    this.keyframeCount = Math.floor((this.end - this.start) / KEYFRAME_INTERVAL_MS) + 1;
+    this.keyframes = new Int32Array(this.keyframeCount * vehicles);
+    this.tracks.forEach((track, slot) => {
+      let index = -1;
+      for (let k = 0; k < this.keyframeCount; k++) {
+        const offset = k * KEYFRAME_INTERVAL_MS;
+        while (index + 1 < track.size && track.offsetAt(index + 1) <= offset) index++;
+        this.keyframes[k * vehicles + slot] = index;
+      }
+    });
+    this.cursors = new Int32Array(vehicles).fill(-1);
+    this.cursorTime = -1;
+  }
+
+  // Full state of every vehicle at `time`. Vehicles not yet reporting are placed
+  // at their first sample as offline, so a backwards seek leaves nothing behind.
+  public seek(time: number): Map<string, VehicleUpdate> {
+    const offset = this.clampOffset(time);
+    const vehicles = this.tracks.length;
+    const k = Math.min(Math.floor(offset / KEYFRAME_INTERVAL_MS), this.keyframeCount - 1);
+    const updates = new Map<string, VehicleUpdate>();
+
+    this.tracks.forEach((track, slot) => {
+      if (track.size === 0) return;
+      const from = this.keyframes[k * vehicles + slot] + 1;
+      const to = k + 1 < this.keyframeCount ? this.keyframes[(k + 1) * vehicles + slot] + 1 : track.size;
+      const index = track.indexAtOrBefore(offset, from, to);
+      this.cursors[slot] = index;
+
+      const id = this.ids[slot];
+      updates.set(id, index >= 0
+        ? track.toUpdate(id, index, this.start)
+        : { ...track.toUpdate(id, 0, this.start), speed: 0, status: VehicleStatus.OFFLINE });
+    });
+
+    this.cursorTime = offset;
+    return updates;
+  }
+
+  // Vehicles whose latest sample changed since the previous call; falls back to a
+  // seek when time moves backwards or skips more than a keyframe interval
+  public advance(time: number): Map<string, VehicleUpdate> {
+    const offset = this.clampOffset(time);
+    if (this.cursorTime < 0 || offset < this.cursorTime || offset - this.cursorTime > KEYFRAME_INTERVAL_MS) {
+      return this.seek(time);
+    }
+
+    const updates = new Map<string, VehicleUpdate>();
+    this.tracks.forEach((track, slot) => {
+      let index = this.cursors[slot];
+      while (index + 1 < track.size && track.offsetAt(index + 1) <= offset) index++;
+      if (index === this.cursors[slot]) return;
+      this.cursors[slot] = index;
+      updates.set(this.ids[slot], track.toUpdate(this.ids[slot], index, this.start));
+    });
+
+    this.cursorTime = offset;
+    return updates;
+  }
+
+  private clampOffset(time: number): number {
+    return Math.max(0, Math.min(time, this.end) - this.start);
+  }
+
+  private trackFor(vehicleId: string): TrackBuffer {
+    let slot = this.slots.get(vehicleId);
+    if (slot === undefined) {
+      slot = this.tracks.length;
+      this.slots.set(vehicleId, slot);
+      this.ids.push(vehicleId);
+      this.tracks.push(new TrackBuffer(this.capacity));
+    }
+    return this.tracks[slot];
+  }
+}
@@ -0,0 +1,124 @@
+import { VehicleData, VehicleStatus } from '../types';
+
+// Inclusive-or-exclusive numeric bounds from expressions like `battery<15` or `speed>=60`
+export interface NumericRange {
+  min: number;
+  max: number;
+  minInclusive: boolean;
+  maxInclusive: boolean;
+}
+
+/**
+ * Search box contents split into ID terms and field expressions:
+ *
+ *   VEH-01 status:moving battery<15 speed>=60 ~veh12
+ *
+ * Plain terms must all appear in the vehicle ID (case-insensitive); `~term`
+ * matches IDs sharing most of the term's trigrams, to tolerate typos.
+ */
+export interface ParsedSearch {
+  terms: string[];
+  fuzzyTerms: string[];
+  status?: VehicleStatus;
+  battery?: NumericRange;
+  speed?: NumericRange;
+}
+
+// Share of a fuzzy term's trigrams an ID must contain
+export const FUZZY_MIN_SIMILARITY = 0.6;
+export const NGRAM_SIZE = 3;
+
+const STATUS_VALUES = new Set<string>(Object.values(VehicleStatus));
+const RANGE_PATTERN = /^(battery|speed)(<=|>=|<|>|=)(-?\d+(?:\.\d+)?)$/;
+
+export const idGrams = (lowerId: string): string[] => {
+  const grams: string[] = [];
+  for (let i = 0; i + NGRAM_SIZE <= lowerId.length; i++) {
+    grams.push(lowerId.slice(i, i + NGRAM_SIZE));
+  }
+  return grams;
+};
+
+const toRange = (op: string, value: number): NumericRange => {
+  switch (op) {
+    case '<':
+      return { min: -Infinity, max: value, minInclusive: true, maxInclusive: false };
+    case '<=':
+      return { min: -Infinity, max: value, minInclusive: true, maxInclusive: true };
+    case '>':
+      return { min: value, max: Infinity, minInclusive: false, maxInclusive: true };
+    case '>=':
+      return { min: value, max: Infinity, minInclusive: true, maxInclusive: true };
+    default:
+      return { min: value, max: value, minInclusive: true, maxInclusive: true };
+  }
+};
+
+// Later expressions on the same field narrow the earlier ones (`battery>10 battery<30`)
+const intersect = (a: NumericRange | undefined, b: NumericRange): NumericRange => {
+  if (!a) return b;
+  const min = Math.max(a.min, b.min);
+  const max = Math.min(a.max, b.max);
+  return {
+    min,
+    max,
+    minInclusive: (a.min !== min || a.minInclusive) && (b.min !== min || b.minInclusive),
+    maxInclusive: (a.max !== max || a.maxInclusive) && (b.max !== max || b.maxInclusive)
+  };
+};
+
+export const inRange = (value: number, range: NumericRange): boolean =>
+  (range.minInclusive ? value >= range.min : value > range.min) &&
+  (range.maxInclusive ? value <= range.max : value < range.max);
+
+let lastQuery: string | null = null;
+let lastParsed: ParsedSearch = { terms: [], fuzzyTerms: [] };
+
+// Memoizes the last query, since every filter check for a flush sees the same string
+export const parseSearchQuery = (query: string): ParsedSearch => {
+  if (query === lastQuery) return lastParsed;
+
+  const parsed: ParsedSearch = { terms: [], fuzzyTerms: [] };
+  query.toLowerCase().split(/\s+/).filter(Boolean).forEach(token => {
+    const range = RANGE_PATTERN.exec(token);
+    if (range) {
+      const field = range[1] as 'battery' | 'speed';
+      parsed[field] = intersect(parsed[field], toRange(range[2], parseFloat(range[3])));
+      return;
+    }
+    if (token.startsWith('status:') && STATUS_VALUES.has(token.slice(7))) {
+      parsed.status = token.slice(7) as VehicleStatus;
+      return;
+    }
+    if (token.startsWith('~') && token.length > 1) {
+      parsed.fuzzyTerms.push(token.slice(1));
+      return;
+    }
+    parsed.terms.push(token);
+  });
+
+  lastQuery = query;
+  lastParsed = parsed;
+  return parsed;
+};
+
+export const fuzzyMatches = (lowerId: string, term: string): boolean => {
+  const grams = Array.from(new Set(idGrams(term)));
+  if (grams.length === 0) return lowerId.includes(term);
+  let shared = 0;
+  grams.forEach(gram => {
+    if (lowerId.includes(gram)) shared++;
+  });
+  return shared >= Math.ceil(grams.length * FUZZY_MIN_SIMILARITY);
+};
+
+export const matchesSearch = (vehicle: VehicleData, search: ParsedSearch): boolean => {
+  if (search.status && vehicle.status !== search.status) return false;
+  if (search.battery && !inRange(vehicle.battery, search.battery)) return false;
+  if (search.speed && !inRange(vehicle.speed, search.speed)) return false;
+  if (search.terms.length === 0 && search.fuzzyTerms.length === 0) return true;
+
+  const lowerId = vehicle.id.toLowerCase();
+  return search.terms.every(term => lowerId.includes(term)) &&
+    search.fuzzyTerms.every(term => fuzzyMatches(lowerId, term));
+};
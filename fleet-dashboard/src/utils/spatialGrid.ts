@@ -0,0 +1,98 @@
+import { GeoBounds } from '../types';
+
+// ~5.5 km cells: small enough that a city viewport touches a few dozen cells
+const DEFAULT_CELL_DEGREES = 0.05;
+
+/**
+ * Uniform lat/lng grid of point IDs. Moving a point only touches its old and
+ * new cells, and a bounds query visits just the cells the bounds overlap, or
+ * only the occupied cells when the bounds cover more cells than are occupied.
+ */
+export class SpatialGrid {
+  private cells: Map<number, Set<string>> = new Map();
+  private cellOf: Map<string, number> = new Map();
+  private cellDegrees: number;
+  private columns: number;
+
+  constructor(cellDegrees: number = DEFAULT_CELL_DEGREES) {
+    this.cellDegrees = cellDegrees;
+    this.columns = Math.ceil(360 / cellDegrees) + 1;
+  }
+
+  public get size(): number {
+    return this.cellOf.size;
+  }
+
+  public upsert(id: string, latitude: number, longitude: number): void {
+    const key = this.keyOf(this.rowOf(latitude), this.columnOf(longitude));
+    const previous = this.cellOf.get(id);
+    if (previous === key) return;
+
+    if (previous !== undefined) this.removeFromCell(previous, id);
+    let cell = this.cells.get(key);
+    if (!cell) {
+      cell = new Set();
+      this.cells.set(key, cell);
+    }
+    cell.add(id);
+    this.cellOf.set(id, key);
+  }
+
+  public remove(id: string): void {
+    const key = this.cellOf.get(id);
+    if (key === undefined) return;
+    this.removeFromCell(key, id);
+    this.cellOf.delete(id);
+  }
+
+  public clear(): void {
+    this.cells.clear();
+    this.cellOf.clear();
+  }
+
+  // IDs in every cell overlapping the bounds; callers needing exact containment filter further
+  public query(bounds: GeoBounds, visit: (id: string) => void): void {
+    const minRow = this.rowOf(bounds.south);
+    const maxRow = this.rowOf(bounds.north);
+    const minColumn = this.columnOf(bounds.west);
+    const maxColumn = this.columnOf(bounds.east);
+
+    // Small viewports walk their cell range; zoomed-out ones scan the occupied cells
+    if ((maxRow - minRow + 1) * (maxColumn - minColumn + 1) <= this.cells.size) {
+      for (let row = minRow; row <= maxRow; row++) {
+        for (let column = minColumn; column <= maxColumn; column++) {
+          this.cells.get(this.keyOf(row, column))?.forEach(visit);
+        }
+      }
+    } else {
+      this.cells.forEach((cell, key) => {
+        const row = Math.floor(key / this.columns);
+        const column = key % this.columns;
+        if (row >= minRow && row <= maxRow && column >= minColumn && column <= maxColumn) cell.forEach(visit);
+      });
+    }
+  }
+
+  private rowOf(latitude: number): number {
+    return Math.floor((Math.max(-90, Math.min(90, latitude)) + 90) / this.cellDegrees);
+  }
+
+  private columnOf(longitude: number): number {
+    return Math.floor((Math.max(-180, Math.min(180, longitude)) + 180) / this.cellDegrees);
+  }
+
+  private keyOf(row: number, column: number): number {
+    return row * this.columns + column;
+  }
+
+  private removeFromCell(key: number, id: string): void {
+    const cell = this.cells.get(key);
+    if (!cell) return;
+    cell.delete(id);
+    if (cell.size === 0) this.cells.delete(key);
+  }
+}
+
+export const containsPoint = (bounds: GeoBounds, latitude: number, longitude: number): boolean =>
+  latitude >= bounds.south && latitude <= bounds.north &&
+  longitude >= bounds.west && longitude <= bounds.east;
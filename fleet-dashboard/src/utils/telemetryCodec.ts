@@ -0,0 +1,162 @@
+import { VehicleData, VehicleStatus } from '../types';
+
+// Compact numeric codes for VehicleStatus, shared by every packed format
+export const STATUS_CODES: VehicleStatus[] = [
+  VehicleStatus.ONLINE,
+  VehicleStatus.MOVING,
+  VehicleStatus.STOPPED,
+  VehicleStatus.OFFLINE,
+  VehicleStatus.LOW_BATTERY
+];
+
+// Marks an absent status in packed columns
+export const STATUS_ABSENT = 255;
+
+const STATUS_TO_CODE = new Map(STATUS_CODES.map((status, code) => [status, code]));
+
+export const encodeStatus = (status: VehicleStatus | undefined): number =>
+  status === undefined ? STATUS_ABSENT : STATUS_TO_CODE.get(status) ?? STATUS_ABSENT;
+
+export const decodeStatus = (code: number): VehicleStatus | undefined => STATUS_CODES[code];
+
+// Per-record layout of PackedVehicleBatch.numbers; NaN marks an absent field
+export enum PackedField {
+  LATITUDE,
+  LONGITUDE,
+  SPEED,
+  BATTERY,
+  ALTITUDE,
+  SATELLITES,
+  TIMESTAMP,
+  COUNT
+}
+
+/**
+ * Columnar, transferable form of a coalesced batch of vehicle updates. IDs are
+ * interned: each side keeps a slot dictionary, and `newIds` carries only the
+ * IDs first seen in this batch (they take the next slots, in order).
+ */
+export interface PackedVehicleBatch {
+  count: number;
+  newIds: string[];
+  slots: Uint32Array;
+  numbers: Float64Array;
+  status: Uint8Array;
+}
+
+export const transferablesOf = (batch: PackedVehicleBatch): ArrayBuffer[] => [
+  batch.slots.buffer as ArrayBuffer,
+  batch.numbers.buffer as ArrayBuffer,
+  batch.status.buffer as ArrayBuffer
+];
+
+const optional = (value: number | undefined): number => (value === undefined ? NaN : value);
+
+export class VehicleIdDictionary {
+  private slotsById: Map<string, number> = new Map();
+  private ids: string[] = [];
+
+  public get size(): number {
+    return this.ids.length;
+  }
+
+  public slotOf(id: string): number | undefined {
+    return this.slotsById.get(id);
+  }
+
+  // Undefined for a slot that was never assigned
+  public idAt(slot: number): string | undefined {
+    return this.ids[slot];
+  }
+
+  public intern(id: string): number {
+    let slot = this.slotsById.get(id);
+    if (slot === undefined) {
+      slot = this.ids.length;
+      this.ids.push(id);
+      this.slotsById.set(id, slot);
+    }
+    return slot;
+  }
+
+  // Binds an ID to a slot chosen by the sender (binary wire frames carry explicit slots)
+  public assign(slot: number, id: string): void {
+    const previous = this.ids[slot];
+    if (previous !== undefined) this.slotsById.delete(previous);
+    this.ids[slot] = id;
+    this.slotsById.set(id, slot);
+  }
+
+  public clear(): void {
+    this.slotsById.clear();
+    this.ids = [];
+  }
+}
+
+export const packVehicleBatch = (
+  updates: Iterable<Partial<VehicleData> & { id: string }>,
+  dictionary: VehicleIdDictionary
+): PackedVehicleBatch => {
+  const records = Array.from(updates);
+  const count = records.length;
+  const slots = new Uint32Array(count);
+  const numbers = new Float64Array(count * PackedField.COUNT);
+  const status = new Uint8Array(count);
+  const newIds: string[] = [];
+
+  records.forEach((update, i) => {
+    const known = dictionary.slotOf(update.id);
+    if (known === undefined) newIds.push(update.id);
+    slots[i] = known ?? dictionary.intern(update.id);
+
+    const base = i * PackedField.COUNT;
+    numbers[base + PackedField.LATITUDE] = optional(update.latitude);
+    numbers[base + PackedField.LONGITUDE] = optional(update.longitude);
+    numbers[base + PackedField.SPEED] = optional(update.speed);
+    numbers[base + PackedField.BATTERY] = optional(update.battery);
+    numbers[base + PackedField.ALTITUDE] = optional(update.altitude);
+    numbers[base + PackedField.SATELLITES] = optional(update.satellites);
+    numbers[base + PackedField.TIMESTAMP] = update.timestamp ? Date.parse(update.timestamp) : NaN;
+    status[i] = encodeStatus(update.status);
+  });
+
+  return { count, newIds, slots, numbers, status };
+};
+
+// Rebuilds the (possibly partial) updates; absent fields are left out of each record
+export const unpackVehicleBatch = (
+  batch: PackedVehicleBatch,
+  dictionary: VehicleIdDictionary
+): Array<Partial<VehicleData> & { id: string }> => {
+  batch.newIds.forEach(id => dictionary.intern(id));
+
+  const { numbers } = batch;
+  const updates: Array<Partial<VehicleData> & { id: string }> = new Array(batch.count);
+
+  for (let i = 0; i < batch.count; i++) {
+    const base = i * PackedField.COUNT;
+    const update: Partial<VehicleData> & { id: string } = { id: dictionary.idAt(batch.slots[i])! };
+
+    const latitude = numbers[base + PackedField.LATITUDE];
+    const longitude = numbers[base + PackedField.LONGITUDE];
+    const speed = numbers[base + PackedField.SPEED];
+    const battery = numbers[base + PackedField.BATTERY];
+    const altitude = numbers[base + PackedField.ALTITUDE];
+    const satellites = numbers[base + PackedField.SATELLITES];
+    const timestamp = numbers[base + PackedField.TIMESTAMP];
+    const status = decodeStatus(batch.status[i]);
+
+    if (!Number.isNaN(latitude)) update.latitude = latitude;
+    if (!Number.isNaN(longitude)) update.longitude = longitude;
+    if (!Number.isNaN(speed)) update.speed = speed;
+    if (!Number.isNaN(battery)) update.battery = battery;
+    if (!Number.isNaN(altitude)) update.altitude = altitude;
+    if (!Number.isNaN(satellites)) update.satellites = satellites;
+    if (!Number.isNaN(timestamp)) update.timestamp = new Date(timestamp).toISOString();
+    if (status !== undefined) update.status = status;
+
+    updates[i] = update;
+  }
+
+  return updates;
+};
@@ -0,0 +1,21 @@
+import { TimeRange } from '../types';
+
+const HOUR_MS = 60 * 60 * 1000;
+
+// Window length of each preset; CUSTOM has no bounds in the filter state yet and uses the last hour
+export const TIME_RANGE_MS: Record<TimeRange, number> = {
+  [TimeRange.LAST_HOUR]: HOUR_MS,
+  [TimeRange.LAST_24H]: 24 * HOUR_MS,
+  [TimeRange.LAST_WEEK]: 7 * 24 * HOUR_MS,
+  [TimeRange.CUSTOM]: HOUR_MS
+};
+
+export interface TimeWindow {
+  start: number; // epoch ms
+  end: number; // epoch ms
+}
+
+export const timeRangeWindow = (range: TimeRange, now: number = Date.now()): TimeWindow => ({
+  start: now - TIME_RANGE_MS[range],
+  end: now
+});
@@ -0,0 +1,83 @@
+const DEFAULT_SLOT_MS = 1000;
+const DEFAULT_SLOTS = 256;
+
+/**
+ * Hashed timer wheel of string IDs. Scheduling and cancelling are O(1);
+ * `advance` only visits the slots whose time has fully elapsed, so a timer
+ * per vehicle costs nothing until it is due and fires at most one slot late.
+ * Pushing a timer later only records the new due time: the timer moves to
+ * its new slot when its old one is swept, which keeps the per-update re-arm
+ * of a constantly reporting vehicle to one map write. Timers further out than
+ * one revolution likewise wait in their slot, lap after lap.
+ */
+export class TimerWheel {
+  private slots: Array<Set<string>>;
+  private dueAt: Map<string, number> = new Map();
+  private slotOf: Map<string, number> = new Map();
+  private slotMs: number;
+  // Last tick whose slot has been processed
+  private tick: number = -1;
+
+  constructor(slotMs: number = DEFAULT_SLOT_MS, slots: number = DEFAULT_SLOTS) {
+    this.slotMs = slotMs;
+    this.slots = Array.from({ length: slots }, () => new Set<string>());
+  }
+
+  public get size(): number {
+    return this.dueAt.size;
+  }
+
+  public schedule(id: string, due: number): void {
+    const previous = this.dueAt.get(id);
+    this.dueAt.set(id, due);
+    if (previous === undefined || due < previous) this.place(id, due);
+  }
+
+  public cancel(id: string): void {
+    const slot = this.slotOf.get(id);
+    if (slot === undefined) return;
+    this.slots[slot].delete(id);
+    this.slotOf.delete(id);
+    this.dueAt.delete(id);
+  }
+
+  // Fires, and forgets, the timers of every elapsed slot that are due by `now`
+  public advance(now: number, onExpire: (id: string) => void): void {
+    // The slot `now` falls in is still filling up
+    const target = Math.floor(now / this.slotMs) - 1;
+    // On the first call or after a long pause one revolution covers every slot
+    const from = Math.max(this.tick + 1, target - this.slots.length + 1);
+    for (let tick = from; tick <= target; tick++) {
+      const slot = this.slots[tick % this.slots.length];
+      slot.forEach((id) => {
+        const due = this.dueAt.get(id)!;
+        if (due > now) {
+          this.place(id, due);
+          return;
+        }
+        slot.delete(id);
+        this.slotOf.delete(id);
+        this.dueAt.delete(id);
+        onExpire(id);
+      });
+    }
+    this.tick = Math.max(this.tick, target);
+  }
+
+  public clear(): void {
+    this.slots.forEach(slot => slot.clear());
+    this.dueAt.clear();
+    this.slotOf.clear();
+    this.tick = -1;
+  }
+
+  // Already-passed due times go into the next slot to be swept rather than one just swept
+  private place(id: string, due: number): void {
+    const slot = Math.max(Math.floor(due / this.slotMs), this.tick + 1) % this.slots.length;
+    const previous = this.slotOf.get(id);
+    if (previous === slot) return;
+    if (previous !== undefined) this.slots[previous].delete(id);
+    this.slots[slot].add(id);
+    this.slotOf.set(id, slot);
+  }
+}
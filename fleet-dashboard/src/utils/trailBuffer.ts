@@ -0,0 +1,71 @@
+// Floats per point: latitude, longitude, seconds since the trail's first point
+const STRIDE = 3;
+
+/**
+ * Fixed-capacity breadcrumb ring for one vehicle. Points are addressed by a
+ * sequence number that keeps counting across wrap-arounds, so a renderer can
+ * ask for exactly the points it has not drawn yet.
+ */
+export class TrailBuffer {
+  public readonly capacity: number;
+  private points: Float32Array;
+  private baseTime: number = 0;
+  // Sequence numbers of the oldest retained point and of the next point to be written
+  private first: number = 0;
+  private next: number = 0;
+
+  constructor(capacity: number) {
+    this.capacity = capacity;
+    this.points = new Float32Array(capacity * STRIDE);
+  }
+
+  public get size(): number {
+    return this.next - this.first;
+  }
+
+  public get firstSeq(): number {
+    return this.first;
+  }
+
+  public get nextSeq(): number {
+    return this.next;
+  }
+
+  // Skips points that do not move the vehicle; returns whether a point was added
+  public push(latitude: number, longitude: number, time: number): boolean {
+    if (this.size === 0) {
+      this.baseTime = time;
+    } else {
+      const last = ((this.next - 1) % this.capacity) * STRIDE;
+      if (this.points[last] === Math.fround(latitude) && this.points[last + 1] === Math.fround(longitude)) return false;
+    }
+    const offset = (this.next % this.capacity) * STRIDE;
+    this.points[offset] = latitude;
+    this.points[offset + 1] = longitude;
+    this.points[offset + 2] = (time - this.baseTime) / 1000;
+    this.next++;
+    if (this.size > this.capacity) this.first++;
+    return true;
+  }
+
+  // Drops points older than `time` (epoch ms) from the front
+  public pruneBefore(time: number): void {
+    const cutoff = (time - this.baseTime) / 1000;
+    while (this.first < this.next && this.points[(this.first % this.capacity) * STRIDE + 2] < cutoff) {
+      this.first++;
+    }
+  }
+
+  // Visits retained points with sequence number >= `seq`, oldest first
+  public forEachSince(seq: number, visit: (latitude: number, longitude: number, seq: number) => void): void {
+    for (let i = Math.max(seq, this.first); i < this.next; i++) {
+      const offset = (i % this.capacity) * STRIDE;
+      visit(this.points[offset], this.points[offset + 1], i);
+    }
+  }
+
+  public clear(): void {
+    this.first = 0;
+    this.next = 0;
+  }
+}
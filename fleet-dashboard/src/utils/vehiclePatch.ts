@@ -0,0 +1,18 @@
+import { PatchField, VehiclePatch, VehicleUpdate } from '../types';
+
+// Extracts the fields flagged in the patch mask into a plain update
+export const patchToUpdate = (patch: VehiclePatch): VehicleUpdate => {
+  const { mask } = patch;
+  const update: VehicleUpdate = { id: patch.id, seq: patch.seq };
+
+  if (mask & PatchField.SPEED) update.speed = patch.speed;
+  if (mask & PatchField.BATTERY) update.battery = patch.battery;
+  if (mask & PatchField.LATITUDE) update.latitude = patch.latitude;
+  if (mask & PatchField.LONGITUDE) update.longitude = patch.longitude;
+  if (mask & PatchField.ALTITUDE) update.altitude = patch.altitude;
+  if (mask & PatchField.SATELLITES) update.satellites = patch.satellites;
+  if (mask & PatchField.TIMESTAMP) update.timestamp = patch.timestamp;
+  if (mask & PatchField.STATUS) update.status = patch.status;
+
+  return update;
+};
@@ -0,0 +1,80 @@
+import { VehicleData, SortField, SortDirection } from '../types';
+import { OrderedIndex } from './orderedIndex';
+
+const sortKeyOf = (vehicle: VehicleData, field: SortField): number => {
+  switch (field) {
+    case SortField.BATTERY:
+      return vehicle.battery;
+    case SortField.SPEED:
+      return vehicle.speed;
+    case SortField.LAST_UPDATE:
+      return vehicle.lastUpdate;
+    default:
+      return 0;
+  }
+};
+
+/**
+ * Filtered vehicles ordered by the active sort field, kept in an indexable
+ * skip list keyed on (sort key, id). A write repositions only that vehicle;
+ * the whole list is rebuilt only when the sort or the filter membership
+ * changes. Descending order is stored as negated keys.
+ */
+export class VehicleSortIndex {
+  private order = new OrderedIndex();
+  private keys: Map<string, number> = new Map();
+  private field: SortField = SortField.NONE;
+  private sign: 1 | -1 = 1;
+
+  public get active(): boolean {
+    return this.field !== SortField.NONE;
+  }
+
+  public get size(): number {
+    return this.order.size;
+  }
+
+  public configure(field: SortField, direction: SortDirection, members: Iterable<VehicleData>): void {
+    this.field = field;
+    this.sign = direction === 'desc' ? -1 : 1;
+    this.order.clear();
+    this.keys.clear();
+    if (!this.active) return;
+
+    for (const vehicle of members) {
+      const key = this.sign * sortKeyOf(vehicle, field);
+      this.order.insert(key, vehicle.id);
+      this.keys.set(vehicle.id, key);
+    }
+  }
+
+  // `member` is whether the vehicle passes the current filters after this write
+  public upsert(vehicle: VehicleData, member: boolean): void {
+    if (!this.active) return;
+    const previous = this.keys.get(vehicle.id);
+    const key = this.sign * sortKeyOf(vehicle, this.field);
+
+    if (member && previous === key) return;
+    if (previous !== undefined) {
+      this.order.remove(previous, vehicle.id);
+      this.keys.delete(vehicle.id);
+    }
+    if (member) {
+      this.order.insert(key, vehicle.id);
+      this.keys.set(vehicle.id, key);
+    }
+  }
+
+  public clear(): void {
+    this.order.clear();
+    this.keys.clear();
+  }
+
+  public idAt(index: number): string | undefined {
+    return this.order.at(index);
+  }
+
+  public slice(start: number, end: number): string[] {
+    return this.order.slice(start, end);
+  }
+}
@@ -0,0 +1,270 @@
+import { VehicleData, VehicleStatus, VehicleUpdate } from '../types';
+import { VersionedMap } from './versionedMap';
+import { STATUS_ABSENT, encodeStatus, decodeStatus } from './telemetryCodec';
+
+const INITIAL_CAPACITY = 1024;
+const SATELLITES_ABSENT = 255;
+
+// Fields the indexes and counters compare between a vehicle's old and new state
+export interface IndexedFields {
+  status: VehicleStatus;
+  battery: number;
+}
+
+// Backing store of the fleet table; readers see it as a versioned ReadonlyMap
+export interface VehicleTable extends ReadonlyMap<string, VehicleData> {
+  readonly version: number;
+  versionOf(vehicleId: string): number;
+  // Merges the update into the stored vehicle and returns it
+  write(vehicleId: string, data: VehicleUpdate, now: number): VehicleData;
+  delete(vehicleId: string): boolean;
+  clear(): void;
+}
+
+// One object per vehicle, replaced by a merged copy on every write
+export class ObjectVehicleTable extends VersionedMap<string, VehicleData> implements VehicleTable {
+  public write(vehicleId: string, data: VehicleUpdate, now: number): VehicleData {
+    const next = {
+      ...this.get(vehicleId),
+      ...data,
+      lastUpdate: now
+    } as VehicleData;
+    this.set(vehicleId, next);
+    return next;
+  }
+}
+
+/**
+ * Read-only VehicleData facade over one slot of a ColumnarVehicleTable. Each
+ * vehicle has exactly one view for the table's lifetime, so its identity does
+ * not change on updates; compare `versionOf` to detect changes. Views are not
+ * plain objects: spread or postMessage `toJSON()` instead. They are invalid
+ * after the table is cleared or the vehicle is deleted.
+ */
+export class VehicleView implements VehicleData {
+  public readonly id: string;
+  private table: ColumnarVehicleTable;
+  // Reassigned by the table when a delete moves this vehicle into the freed slot
+  public slot: number;
+
+  constructor(table: ColumnarVehicleTable, slot: number, id: string) {
+    this.table = table;
+    this.slot = slot;
+    this.id = id;
+  }
+
+  public get latitude(): number {
+    return this.table.latitude[this.slot];
+  }
+
+  public get longitude(): number {
+    return this.table.longitude[this.slot];
+  }
+
+  public get speed(): number {
+    return this.table.speed[this.slot];
+  }
+
+  public get battery(): number {
+    return this.table.battery[this.slot];
+  }
+
+  public get status(): VehicleStatus {
+    return decodeStatus(this.table.status[this.slot]) ?? VehicleStatus.OFFLINE;
+  }
+
+  public get lastUpdate(): number {
+    return this.table.lastUpdate[this.slot];
+  }
+
+  // Formatted on read; hot paths should use `table.timestamp` (epoch ms) instead
+  public get timestamp(): string {
+    const time = this.table.timestamp[this.slot];
+    return Number.isNaN(time) ? '' : new Date(time).toISOString();
+  }
+
+  public get altitude(): number | undefined {
+    const altitude = this.table.altitude[this.slot];
+    return Number.isNaN(altitude) ? undefined : altitude;
+  }
+
+  public get satellites(): number | undefined {
+    const satellites = this.table.satellites[this.slot];
+    return satellites === SATELLITES_ABSENT ? undefined : satellites;
+  }
+
+  public get seq(): number | undefined {
+    const seq = this.table.seq[this.slot];
+    return Number.isNaN(seq) ? undefined : seq;
+  }
+
+  public toJSON(): VehicleData {
+    return {
+      id: this.id,
+      speed: this.speed,
+      battery: this.battery,
+      latitude: this.latitude,
+      longitude: this.longitude,
+      altitude: this.altitude,
+      satellites: this.satellites,
+      timestamp: this.timestamp,
+      status: this.status,
+      lastUpdate: this.lastUpdate,
+      seq: this.seq
+    };
+  }
+}
+
+/**
+ * Struct-of-arrays fleet table. Vehicle IDs are interned to slots on first
+ * write and every field lives in a typed column, so a write only stores
+ * numbers and allocates nothing once the vehicle exists. Battery keeps its
+ * fraction, so low-battery checks agree with the object table. Columns are public for readers that want to scan them
+ * directly (look slots up with `slotOf`); they are replaced when the table
+ * grows, so re-read the property instead of holding on to an array. A delete
+ * moves the last vehicle into the freed slot, so slots are not stable either.
+ */
+export class ColumnarVehicleTable implements VehicleTable {
+  public latitude = new Float64Array(INITIAL_CAPACITY);
+  public longitude = new Float64Array(INITIAL_CAPACITY);
+  public speed = new Float32Array(INITIAL_CAPACITY);
+  public battery = new Float32Array(INITIAL_CAPACITY);
+  public status = new Uint8Array(INITIAL_CAPACITY);
+  public timestamp = new Float64Array(INITIAL_CAPACITY); // epoch ms, NaN when unknown
+  public lastUpdate = new Float64Array(INITIAL_CAPACITY);
+  public altitude = new Float32Array(INITIAL_CAPACITY);
+  public satellites = new Uint8Array(INITIAL_CAPACITY);
+  public seq = new Float64Array(INITIAL_CAPACITY);
+  private versions = new Float64Array(INITIAL_CAPACITY);
+  private slots: Map<string, number> = new Map();
+  private views: VehicleView[] = [];
+  private currentVersion: number = 0;
+
+  public get version(): number {
+    return this.currentVersion;
+  }
+
+  public get size(): number {
+    return this.views.length;
+  }
+
+  public slotOf(vehicleId: string): number | undefined {
+    return this.slots.get(vehicleId);
+  }
+
+  public versionOf(vehicleId: string): number {
+    const slot = this.slots.get(vehicleId);
+    return slot === undefined ? 0 : this.versions[slot];
+  }
+
+  public get(vehicleId: string): VehicleData | undefined {
+    const slot = this.slots.get(vehicleId);
+    return slot === undefined ? undefined : this.views[slot];
+  }
+
+  public has(vehicleId: string): boolean {
+    return this.slots.has(vehicleId);
+  }
+
+  public write(vehicleId: string, data: VehicleUpdate, now: number): VehicleData {
+    let slot = this.slots.get(vehicleId);
+    if (slot === undefined) slot = this.intern(vehicleId);
+
+    if (data.latitude !== undefined) this.latitude[slot] = data.latitude;
+    if (data.longitude !== undefined) this.longitude[slot] = data.longitude;
+    if (data.speed !== undefined) this.speed[slot] = data.speed;
+    if (data.battery !== undefined) this.battery[slot] = data.battery;
+    if (data.status !== undefined) this.status[slot] = encodeStatus(data.status);
+    if (data.timestamp !== undefined) this.timestamp[slot] = Date.parse(data.timestamp);
+    if (data.altitude !== undefined) this.altitude[slot] = data.altitude;
+    if (data.satellites !== undefined) this.satellites[slot] = data.satellites;
+    if (data.seq !== undefined) this.seq[slot] = data.seq;
+    this.lastUpdate[slot] = now;
+    this.versions[slot] = ++this.currentVersion;
+    return this.views[slot];
+  }
+
+  public delete(vehicleId: string): boolean {
+    const slot = this.slots.get(vehicleId);
+    if (slot === undefined) return false;
+    this.slots.delete(vehicleId);
+    const last = this.views.length - 1;
+    const moved = this.views.pop()!;
+    if (slot !== last) {
+      // Keeps the columns dense: the last vehicle takes over the freed slot
+      const columns = [
+        this.latitude, this.longitude, this.speed, this.battery, this.status, this.timestamp,
+        this.lastUpdate, this.altitude, this.satellites, this.seq, this.versions
+      ];
+      columns.forEach(column => { column[slot] = column[last]; });
+      moved.slot = slot;
+      this.views[slot] = moved;
+      this.slots.set(moved.id, slot);
+    }
+    this.currentVersion++;
+    return true;
+  }
+
+  public clear(): void {
+    this.slots.clear();
+    this.views = [];
+    this.currentVersion++;
+  }
+
+  public forEach(callback: (value: VehicleData, key: string, map: ReadonlyMap<string, VehicleData>) => void): void {
+    this.views.forEach(view => callback(view, view.id, this));
+  }
+
+  public keys(): IterableIterator<string> {
+    return this.slots.keys();
+  }
+
+  public values(): IterableIterator<VehicleData> {
+    return this.views.values();
+  }
+
+  public *entries(): IterableIterator<[string, VehicleData]> {
+    for (const view of this.views) yield [view.id, view];
+  }
+
+  public [Symbol.iterator](): IterableIterator<[string, VehicleData]> {
+    return this.entries();
+  }
+
+  private intern(vehicleId: string): number {
+    const slot = this.views.length;
+    if (slot === this.versions.length) this.grow();
+    this.slots.set(vehicleId, slot);
+    this.views.push(new VehicleView(this, slot, vehicleId));
+
+    this.latitude[slot] = 0;
+    this.longitude[slot] = 0;
+    this.speed[slot] = 0;
+    this.battery[slot] = 0;
+    this.status[slot] = STATUS_ABSENT;
+    this.timestamp[slot] = NaN;
+    this.altitude[slot] = NaN;
+    this.satellites[slot] = SATELLITES_ABSENT;
+    this.seq[slot] = NaN;
+    return slot;
+  }
+
+  private grow(): void {
+    const capacity = this.versions.length * 2;
+    const resize = <T extends Float64Array | Float32Array | Uint8Array>(column: T, next: T): T => {
+      next.set(column);
+      return next;
+    };
+    this.latitude = resize(this.latitude, new Float64Array(capacity));
+    this.longitude = resize(this.longitude, new Float64Array(capacity));
+    this.speed = resize(this.speed, new Float32Array(capacity));
+    this.battery = resize(this.battery, new Float32Array(capacity));
+    this.status = resize(this.status, new Uint8Array(capacity));
+    this.timestamp = resize(this.timestamp, new Float64Array(capacity));
+    this.lastUpdate = resize(this.lastUpdate, new Float64Array(capacity));
+    this.altitude = resize(this.altitude, new Float32Array(capacity));
+    this.satellites = resize(this.satellites, new Uint8Array(capacity));
+    this.seq = resize(this.seq, new Float64Array(capacity));
+    this.versions = resize(this.versions, new Float64Array(capacity));
+  }
+}
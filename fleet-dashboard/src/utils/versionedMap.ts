@@ -0,0 +1,71 @@
+/**
+ * Mutable map that stamps every write with a monotonically increasing
+ * version. Writers mutate in place (O(1) per entry instead of copying the
+ * whole map), and readers detect changes by comparing `version` or
+ * `versionOf(key)` against the last value they saw.
+ */
+export class VersionedMap<K, V> implements ReadonlyMap<K, V> {
+  private entriesByKey: Map<K, V> = new Map();
+  private versions: Map<K, number> = new Map();
+  private currentVersion: number = 0;
+
+  public get version(): number {
+    return this.currentVersion;
+  }
+
+  public get size(): number {
+    return this.entriesByKey.size;
+  }
+
+  // Version at which the entry was last written, or 0 if it does not exist
+  public versionOf(key: K): number {
+    return this.versions.get(key) ?? 0;
+  }
+
+  public get(key: K): V | undefined {
+    return this.entriesByKey.get(key);
+  }
+
+  public has(key: K): boolean {
+    return this.entriesByKey.has(key);
+  }
+
+  public set(key: K, value: V): void {
+    this.currentVersion++;
+    this.entriesByKey.set(key, value);
+    this.versions.set(key, this.currentVersion);
+  }
+
+  public delete(key: K): boolean {
+    if (!this.entriesByKey.delete(key)) return false;
+    this.versions.delete(key);
+    this.currentVersion++;
+    return true;
+  }
+
+  public clear(): void {
+    this.entriesByKey.clear();
+    this.versions.clear();
+    this.currentVersion++;
+  }
+
+  public forEach(callback: (value: V, key: K, map: ReadonlyMap<K, V>) => void): void {
+    this.entriesByKey.forEach((value, key) => callback(value, key, this));
+  }
+
+  public keys() {
+    return this.entriesByKey.keys();
+  }
+
+  public values() {
+    return this.entriesByKey.values();
+  }
+
+  public entries() {
+    return this.entriesByKey.entries();
+  }
+
+  public [Symbol.iterator]() {
+    return this.entriesByKey[Symbol.iterator]();
+  }
+}
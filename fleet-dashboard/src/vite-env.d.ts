@@ -3,7 +3,22 @@
 interface ImportMetaEnv {
   readonly VITE_API_URL: string
   readonly VITE_WS_URL: string
+  readonly VITE_MOCK_TELEMETRY?: string
   readonly VITE_UPDATE_BATCH_INTERVAL: string
+  readonly VITE_INGEST_MODE?: 'main' | 'worker' | 'shared'
+  readonly VITE_WS_BINARY?: string
+  readonly VITE_FLUSH_SCHEDULE?: 'timeout' | 'frame'
+  readonly VITE_MAP_RENDERER?: 'markers' | 'webgl'
+  readonly VITE_VIEWPORT_CULLING?: string
+  readonly VITE_TRAILS?: string
+  readonly VITE_VEHICLE_STORE?: 'objects' | 'columnar'
+  readonly VITE_TRAIL_MINUTES?: string
+  readonly VITE_WARM_START?: string
+  readonly VITE_PERF_METRICS?: string
+  readonly VITE_PERF_TRACE?: string
+  readonly VITE_METRICS_EXPORT_INTERVAL?: string
+  readonly VITE_BENCHMARK?: string
+  readonly VITE_ALERTS?: string
 }
 
 interface ImportMeta {
@@ -0,0 +1,38 @@
+import { ClusterIndex } from '../utils/clusterIndex';
+import { STATUS_ABSENT } from '../utils/telemetryCodec';
+import { ClusterWorkerCommand, ClusterWorkerEvent } from './protocol';
+
+// Keeps the hierarchical cluster index off the main thread; the map only
+// receives the features for its current zoom and bounds.
+
+const index = new ClusterIndex();
+
+const post = (event: ClusterWorkerEvent) => {
+  self.postMessage(event);
+};
+
+self.onmessage = (event: MessageEvent<ClusterWorkerCommand>) => {
+  const command = event.data;
+  switch (command.type) {
+    case 'update': {
+      const { ids, latitude, longitude, status } = command.points;
+      for (let i = 0; i < ids.length; i++) {
+        if (status[i] === STATUS_ABSENT) {
+          index.remove(ids[i]);
+        } else {
+          index.upsert(ids[i], latitude[i], longitude[i], status[i]);
+        }
+      }
+      break;
+    }
+    case 'clear':
+      index.clear();
+      break;
+    case 'query': {
+      const start = performance.now();
+      const features = index.query(command.bounds, command.zoom);
+      post({ type: 'clusters', requestId: command.requestId, features, queryMs: performance.now() - start });
+      break;
+    }
+  }
+};
@@ -0,0 +1,57 @@
+import { ConnectionStatus, ViewportBounds, ClusterSummary, GeoBounds, IngestFocus, FleetCounts } from '../types';
+import { ErrorData, TelemetryClientOptions } from '../api/websocketClient';
+import { PackedVehicleBatch } from '../utils/telemetryCodec';
+import { ClusterFeature } from '../utils/clusterIndex';
+import { FilterCriteria } from '../utils/filterIndex';
+import { MetricsSnapshot } from '../utils/perfMetrics';
+
+// Messages posted from the main thread to the telemetry worker
+export type TelemetryWorkerCommand =
+  | { type: 'connect'; url: string; token: string; options: TelemetryClientOptions }
+  | { type: 'disconnect' }
+  | { type: 'commit'; durationMs: number } // main-thread time spent applying the last batch
+  | { type: 'visibility'; hidden: boolean }
+  | { type: 'viewport'; viewport: ViewportBounds }
+  | { type: 'focus'; focus: IngestFocus }; // what load shedding must not delay
+
+// Messages posted from the telemetry worker to the main thread
+export type TelemetryWorkerEvent =
+  | { type: 'batch'; batch: PackedVehicleBatch }
+  | { type: 'connection'; status: ConnectionStatus }
+  | { type: 'clusters'; summaries: ClusterSummary[] }
+  | { type: 'error'; error: ErrorData }
+  | { type: 'metrics'; metrics: MetricsSnapshot }; // one perf window recorded in the worker
+
+// Messages posted from a tab to the shared telemetry worker
+export type SharedTelemetryCommand =
+  | { type: 'connect'; url: string; token: string; options: TelemetryClientOptions }
+  | { type: 'disconnect' } // the tab is going away
+  | { type: 'filter'; criteria: FilterCriteria } // only deltas of matching vehicles are forwarded
+  | { type: 'visibility'; hidden: boolean }
+  | { type: 'viewport'; viewport: ViewportBounds }
+  | { type: 'focus'; focus: IngestFocus };
+
+// Messages posted from the shared telemetry worker to a tab: the dedicated worker's events,
+// plus the vehicles it stopped forwarding and the counters of its whole table
+export type SharedTelemetryEvent =
+  | TelemetryWorkerEvent
+  | { type: 'remove'; vehicleIds: string[] }
+  | { type: 'counts'; counts: FleetCounts };
+
+// Columnar point changes for the cluster worker; status STATUS_ABSENT removes the point
+export interface ClusterPointBatch {
+  ids: string[];
+  latitude: Float64Array;
+  longitude: Float64Array;
+  status: Uint8Array;
+}
+
+// Messages posted from the main thread to the cluster worker
+export type ClusterWorkerCommand =
+  | { type: 'update'; points: ClusterPointBatch }
+  | { type: 'clear' }
+  | { type: 'query'; requestId: number; bounds: GeoBounds; zoom: number };
+
+// Messages posted from the cluster worker to the main thread
+export type ClusterWorkerEvent =
+  | { type: 'clusters'; requestId: number; features: ClusterFeature[]; queryMs: number };
@@ -0,0 +1,306 @@
+import { TelemetryWebSocketClient, TelemetryClientOptions } from '../api/websocketClient';
+import { VehicleUpdateBatcher } from '../utils/batcher';
+import { packVehicleBatch, transferablesOf, VehicleIdDictionary } from '../utils/telemetryCodec';
+import { FilterCriteria, matchesFilters } from '../utils/filterIndex';
+import { ObjectVehicleTable } from '../utils/vehicleTable';
+import { createCounts, recountVehicle } from '../utils/fleetCounts';
+import { forwardMetricsWindows } from '../utils/perfMetrics';
+import { SharedTelemetryCommand, SharedTelemetryEvent } from './protocol';
+import { ConnectionStatus, ClusterSummary, GeoBounds, IngestFocus, VehicleData, ViewportBounds } from '../types';
+
+// One socket for every tab of the dashboard. The worker parses and coalesces the
+// stream, keeps the authoritative vehicle table and forwards to each tab the
+// merged state of the vehicles its filters select, plus counters of the whole fleet.
+
+// The app compiles against the DOM lib only; this is the part of SharedWorkerGlobalScope used here
+declare const self: { onconnect: ((event: MessageEvent) => void) | null };
+
+const FLUSH_INTERVAL_MS = 100;
+// Background tabs receive their accumulated deltas this often
+const HIDDEN_FLUSH_INTERVAL_MS = 1000;
+// Keeps the socket through a reload of the last open tab
+const IDLE_DISCONNECT_MS = 5000;
+
+interface Subscriber {
+  port: MessagePort;
+  // Per-port, because each tab mirrors the dictionary of the batches it received
+  dictionary: VehicleIdDictionary;
+  criteria: FilterCriteria | null;
+  // Vehicles this tab holds; the tab is told to drop them once they leave its filter
+  forwarded: Set<string>;
+  viewport: ViewportBounds | null;
+  focus: IngestFocus | null;
+  hidden: boolean;
+  // Vehicles changed while the tab was hidden
+  pending: Set<string>;
+}
+
+const subscribers: Set<Subscriber> = new Set();
+const vehicles = new ObjectVehicleTable();
+// Over every vehicle in the table; a tab's own counters only cover what it was forwarded
+let counts = createCounts();
+let client: TelemetryWebSocketClient | null = null;
+let batcher: VehicleUpdateBatcher | null = null;
+let connectionKey: string | null = null;
+let lastStatus: ConnectionStatus | null = null;
+let lastSummaries: ClusterSummary[] | null = null;
+let idleTimer: number | null = null;
+
+const post = (subscriber: Subscriber, event: SharedTelemetryEvent, transfer: Transferable[] = []) => {
+  subscriber.port.postMessage(event, transfer);
+};
+
+const broadcast = (event: SharedTelemetryEvent) => {
+  subscribers.forEach(subscriber => post(subscriber, event));
+};
+
+// Every tab reports the shared socket's ingest metrics alongside its own rendering ones
+forwardMetricsWindows(metrics => broadcast({ type: 'metrics', metrics }));
+
+const selects = (subscriber: Subscriber, vehicle: VehicleData) =>
+  !subscriber.criteria || matchesFilters(vehicle, subscriber.criteria);
+
+const sendVehicles = (subscriber: Subscriber, records: VehicleData[], removed: string[] = []) => {
+  if (removed.length > 0) post(subscriber, { type: 'remove', vehicleIds: removed });
+  if (records.length === 0) return;
+  const batch = packVehicleBatch(records, subscriber.dictionary);
+  post(subscriber, { type: 'batch', batch }, transferablesOf(batch));
+};
+
+const sendCounts = (subscriber: Subscriber) => {
+  post(subscriber, { type: 'counts', counts });
+};
+
+// Full state of every vehicle the tab selects after a (re)subscribe; vehicles it
+// held that the new filters no longer select are removed
+const sendSnapshot = (subscriber: Subscriber) => {
+  const records: VehicleData[] = [];
+  const previous = subscriber.forwarded;
+  subscriber.forwarded = new Set();
+  subscriber.pending.clear();
+  vehicles.forEach(vehicle => {
+    if (selects(subscriber, vehicle)) {
+      records.push(vehicle);
+      subscriber.forwarded.add(vehicle.id);
+    }
+  });
+  const removed: string[] = [];
+  previous.forEach(id => {
+    if (!subscriber.forwarded.has(id)) removed.push(id);
+  });
+  sendVehicles(subscriber, records, removed);
+  sendCounts(subscriber);
+};
+
+const forward = (subscriber: Subscriber, changed: Iterable<VehicleData>) => {
+  const records: VehicleData[] = [];
+  const removed: string[] = [];
+  for (const vehicle of changed) {
+    if (selects(subscriber, vehicle)) {
+      subscriber.forwarded.add(vehicle.id);
+      records.push(vehicle);
+    } else if (subscriber.forwarded.delete(vehicle.id)) {
+      removed.push(vehicle.id);
+    }
+  }
+  sendVehicles(subscriber, records, removed);
+};
+
+const flushPending = (subscriber: Subscriber) => {
+  if (subscriber.pending.size === 0) return;
+  const changed: VehicleData[] = [];
+  subscriber.pending.forEach(id => {
+    const vehicle = vehicles.get(id);
+    if (vehicle) changed.push(vehicle);
+  });
+  subscriber.pending.clear();
+  forward(subscriber, changed);
+  sendCounts(subscriber);
+};
+
+const fanOut = (changed: VehicleData[], countsChanged: boolean) => {
+  subscribers.forEach(subscriber => {
+    if (subscriber.hidden) {
+      changed.forEach(vehicle => subscriber.pending.add(vehicle.id));
+    } else {
+      forward(subscriber, changed);
+      if (countsChanged) sendCounts(subscriber);
+    }
+  });
+};
+
+setInterval(() => {
+  subscribers.forEach(subscriber => {
+    if (subscriber.hidden) flushPending(subscriber);
+  });
+}, HIDDEN_FLUSH_INTERVAL_MS);
+
+// The socket can only follow one area: the union of the tabs' viewports at the lowest zoom
+const updateViewport = () => {
+  let union: ViewportBounds | null = null;
+  subscribers.forEach(({ viewport }) => {
+    if (!viewport) return;
+    union = union
+      ? {
+          south: Math.min(union.south, viewport.south),
+          west: Math.min(union.west, viewport.west),
+          north: Math.max(union.north, viewport.north),
+          east: Math.max(union.east, viewport.east),
+          zoom: Math.min(union.zoom, viewport.zoom)
+        }
+      : { ...viewport };
+  });
+  if (union) client?.subscribeViewport(union);
+};
+
+// Shedding may only delay what no tab is looking at: the union of their focus areas,
+// clustered only if every tab clusters, and every tab's selected and pinned vehicles
+const updateFocus = () => {
+  let bounds: GeoBounds | null = null;
+  // A tab without bounds treats every vehicle as on screen
+  let unbounded = false;
+  let clustered = true;
+  const vehicleIds: Set<string> = new Set();
+  let any = false;
+  subscribers.forEach(({ focus }) => {
+    if (!focus) return;
+    any = true;
+    clustered = clustered && focus.clustered;
+    focus.vehicleIds.forEach(id => vehicleIds.add(id));
+    if (!focus.bounds) {
+      unbounded = true;
+      return;
+    }
+    bounds = bounds
+      ? {
+          south: Math.min(bounds.south, focus.bounds.south),
+          west: Math.min(bounds.west, focus.bounds.west),
+          north: Math.max(bounds.north, focus.bounds.north),
+          east: Math.max(bounds.east, focus.bounds.east)
+        }
+      : { ...focus.bounds };
+  });
+  if (any) client?.setFocus({ bounds: unbounded ? null : bounds, clustered, vehicleIds: Array.from(vehicleIds) });
+};
+
+const teardown = () => {
+  batcher?.destroy();
+  client?.disconnect();
+  batcher = null;
+  client = null;
+  connectionKey = null;
+  lastStatus = null;
+  lastSummaries = null;
+  vehicles.clear();
+  counts = createCounts();
+};
+
+const connect = (url: string, token: string, options: TelemetryClientOptions) => {
+  const key = JSON.stringify([url, token, options]);
+  if (client && key === connectionKey) return;
+  teardown();
+  connectionKey = key;
+
+  const socketClient = new TelemetryWebSocketClient(url, token, options);
+  client = socketClient;
+  batcher = new VehicleUpdateBatcher(FLUSH_INTERVAL_MS, (updates) => {
+    const now = Date.now();
+    const changed: VehicleData[] = [];
+    let countsChanged = false;
+    updates.forEach((data, vehicleId) => {
+      // Writes replace the stored object, so the previous one still holds the old fields
+      const previous = vehicles.get(vehicleId);
+      const next = vehicles.write(vehicleId, data, now);
+      if (recountVehicle(counts, previous, next)) countsChanged = true;
+      changed.push(next);
+    });
+    fanOut(changed, countsChanged);
+  }, {
+    onResync: (vehicleIds) => socketClient.requestResync(vehicleIds),
+    schedule: 'timeout'
+  });
+
+  // Reconnect with backoff and stale detection run here, inside the shared client
+  client.onMessage((data) => {
+    if (Array.isArray(data)) {
+      batcher?.addBatch(data);
+    } else {
+      batcher?.addUpdate(data.id, data);
+    }
+  });
+  client.onPatch((patches) => batcher?.addPatches(patches));
+  client.onStreamReset(() => batcher?.forget());
+  client.onConnectionChange((status) => {
+    lastStatus = status;
+    broadcast({ type: 'connection', status });
+  });
+  client.onError((error) => broadcast({ type: 'error', error }));
+  client.onClusterSummary((summaries) => {
+    lastSummaries = summaries;
+    broadcast({ type: 'clusters', summaries });
+  });
+  updateViewport();
+  updateFocus();
+  client.connect();
+};
+
+const handleCommand = (subscriber: Subscriber, command: SharedTelemetryCommand) => {
+  switch (command.type) {
+    case 'connect':
+      if (idleTimer !== null) {
+        clearTimeout(idleTimer);
+        idleTimer = null;
+      }
+      subscribers.add(subscriber);
+      subscriber.dictionary = new VehicleIdDictionary();
+      connect(command.url, command.token, command.options);
+      if (lastStatus) post(subscriber, { type: 'connection', status: lastStatus });
+      if (lastSummaries) post(subscriber, { type: 'clusters', summaries: lastSummaries });
+      sendSnapshot(subscriber);
+      break;
+    case 'disconnect':
+      subscribers.delete(subscriber);
+      subscriber.port.close();
+      updateViewport();
+      updateFocus();
+      if (subscribers.size === 0) {
+        idleTimer = setTimeout(() => {
+          idleTimer = null;
+          if (subscribers.size === 0) teardown();
+        }, IDLE_DISCONNECT_MS);
+      }
+      break;
+    case 'filter':
+      subscriber.criteria = command.criteria;
+      if (subscribers.has(subscriber)) sendSnapshot(subscriber);
+      break;
+    case 'visibility':
+      subscriber.hidden = command.hidden;
+      if (!command.hidden) flushPending(subscriber);
+      break;
+    case 'viewport':
+      subscriber.viewport = command.viewport;
+      updateViewport();
+      break;
+    case 'focus':
+      subscriber.focus = command.focus;
+      updateFocus();
+      break;
+  }
+};
+
+self.onconnect = (event: MessageEvent) => {
+  const port = event.ports[0];
+  const subscriber: Subscriber = {
+    port,
+    dictionary: new VehicleIdDictionary(),
+    criteria: null,
+    forwarded: new Set(),
+    viewport: null,
+    focus: null,
+    hidden: false,
+    pending: new Set()
+  };
+  port.onmessage = (message: MessageEvent<SharedTelemetryCommand>) => handleCommand(subscriber, message.data);
+  port.start();
+};
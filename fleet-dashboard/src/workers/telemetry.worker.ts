@@ -0,0 +1,92 @@
+import { TelemetryWebSocketClient, TelemetryClientOptions } from '../api/websocketClient';
+import { VehicleUpdateBatcher } from '../utils/batcher';
+import { packVehicleBatch, transferablesOf, VehicleIdDictionary } from '../utils/telemetryCodec';
+import { TelemetryWorkerCommand, TelemetryWorkerEvent } from './protocol';
+import { IngestFocus, ViewportBounds } from '../types';
+import { forwardMetricsWindows } from '../utils/perfMetrics';
+
+// Owns the socket, JSON parsing and per-vehicle coalescing so the UI thread
+// only receives one packed delta per frame.
+
+// Upper bound on the flush period when the main thread reports slow commits
+const MAX_FLUSH_INTERVAL_MS = 100;
+
+let client: TelemetryWebSocketClient | null = null;
+let batcher: VehicleUpdateBatcher | null = null;
+let dictionary = new VehicleIdDictionary();
+// Kept across reconnects so a fresh client subscribes to the same area
+let viewport: ViewportBounds | null = null;
+let focus: IngestFocus | null = null;
+
+const post = (event: TelemetryWorkerEvent, transfer: Transferable[] = []) => {
+  self.postMessage(event, { transfer });
+};
+
+// Socket and batcher timings are recorded here; the main thread merges them into its own
+forwardMetricsWindows(metrics => post({ type: 'metrics', metrics }));
+
+const teardown = () => {
+  batcher?.destroy();
+  client?.disconnect();
+  batcher = null;
+  client = null;
+};
+
+const connect = (url: string, token: string, options: TelemetryClientOptions) => {
+  teardown();
+  dictionary = new VehicleIdDictionary();
+
+  const socketClient = new TelemetryWebSocketClient(url, token, options);
+  client = socketClient;
+
+  batcher = new VehicleUpdateBatcher(MAX_FLUSH_INTERVAL_MS, (updates) => {
+    const batch = packVehicleBatch(updates.values(), dictionary);
+    post({ type: 'batch', batch }, transferablesOf(batch));
+  }, {
+    onResync: (vehicleIds) => socketClient.requestResync(vehicleIds),
+    schedule: 'frame',
+    externalCommitTiming: true
+  });
+
+  client.onMessage((data) => {
+    if (Array.isArray(data)) {
+      batcher?.addBatch(data);
+    } else {
+      batcher?.addUpdate(data.id, data);
+    }
+  });
+  client.onPatch((patches) => batcher?.addPatches(patches));
+  client.onStreamReset(() => batcher?.forget());
+  client.onConnectionChange((status) => post({ type: 'connection', status }));
+  client.onError((error) => post({ type: 'error', error }));
+  client.onClusterSummary((summaries) => post({ type: 'clusters', summaries }));
+  if (viewport) client.subscribeViewport(viewport);
+  if (focus) client.setFocus(focus);
+  client.connect();
+};
+
+self.onmessage = (event: MessageEvent<TelemetryWorkerCommand>) => {
+  const command = event.data;
+  switch (command.type) {
+    case 'connect':
+      connect(command.url, command.token, command.options);
+      break;
+    case 'disconnect':
+      teardown();
+      break;
+    case 'commit':
+      batcher?.reportCommitTime(command.durationMs);
+      break;
+    case 'visibility':
+      batcher?.setHidden(command.hidden);
+      break;
+    case 'viewport':
+      viewport = command.viewport;
+      client?.subscribeViewport(viewport);
+      break;
+    case 'focus':
+      focus = command.focus;
+      client?.setFocus(focus);
+      break;
+  }
+};
@@ -3,6 +3,9 @@ import react from '@vitejs/plugin-react';
 
 export default defineConfig({
   plugins: [react()],
+  worker: {
+    format: 'es'
+  },
   build: {
     target: 'esnext',
     minify: 'esbuild',